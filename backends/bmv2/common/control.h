@@ -432,6 +432,19 @@ class ControlConverter : public Inspector {
         auto entriesList = table->getEntries();
         if (entriesList == nullptr) return;
 
+        // The match kind and width of each key column are the same for
+        // every entry; resolve them once rather than once per entry.
+        struct KeyColumn {
+            cstring matchType;
+            int keyWidth;
+            int k8;
+        };
+        std::vector<KeyColumn> columns;
+        for (auto tableKey : table->getKey()->keyElements) {
+            auto keyWidth = tableKey->expression->type->width_bits();
+            columns.push_back({ getKeyMatchType(tableKey), keyWidth, ROUNDUP(keyWidth, 8) });
+        }
+
         auto entries = mkArrayField(jsonTable, "entries");
         int entryPriority = 1;  // default priority is defined by index position
         for (auto e : entriesList->entries) {
@@ -440,13 +453,13 @@ class ControlConverter : public Inspector {
 
             auto keyset = e->getKeys();
             auto matchKeys = mkArrayField(entry, "match_key");
-            int keyIndex = 0;
+            size_t keyIndex = 0;
             for (auto k : keyset->components) {
                 auto key = new Util::JsonObject();
-                auto tableKey = table->getKey()->keyElements.at(keyIndex);
-                auto keyWidth = tableKey->expression->type->width_bits();
-                auto k8 = ROUNDUP(keyWidth, 8);
-                auto matchType = getKeyMatchType(tableKey);
+                BUG_CHECK(keyIndex < columns.size(), "%1%: too many keys in entry", e);
+                auto keyWidth = columns[keyIndex].keyWidth;
+                auto k8 = columns[keyIndex].k8;
+                auto matchType = columns[keyIndex].matchType;
                 // Table key fields with match_kind optional will be
                 // represented in the BMv2 JSON file the same as a ternary
                 // field would be.
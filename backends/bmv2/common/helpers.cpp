@@ -57,20 +57,24 @@ Util::JsonObject* mkPrimitive(cstring name) {
 }
 
 cstring stringRepr(big_int value, unsigned bytes) {
-    cstring sign = "";
-    std::stringstream r;
-    cstring filler = "";
+    // Build the whole representation in one buffer and intern it once;
+    // this is called for every key and action datum of every table entry.
+    std::string result;
     if (value < 0) {
         value =- value;
-        sign = "-"; }
+        result = "-"; }
+    std::stringstream r;
     r << std::hex << value;
+    std::string digits = r.str();
 
+    result += "0x";
     if (bytes > 0) {
-        int digits = bytes * 2 - r.str().size();
-        BUG_CHECK(digits >= 0, "Cannot represent %1% on %2% bytes", value, bytes);
-        filler = std::string(digits, '0');
+        int filler = bytes * 2 - digits.size();
+        BUG_CHECK(filler >= 0, "Cannot represent %1% on %2% bytes", value, bytes);
+        result.append(filler, '0');
     }
-    return sign + "0x" + filler + r.str();
+    result += digits;
+    return result;
 }
 
 unsigned nextId(cstring group) {
@@ -97,7 +97,9 @@ void PsaSwitchBackend::convert(const IR::ToplevelBlock *tlb) {
         return;
     PassManager post_code_gen = {
         new EliminateUnusedAction(),
-        new DpdkAsmOptimization,
+        new DpdkAsmOptimization(rewriteToDpdkArch->localVariables),
+        new PackLocalVariables(rewriteToDpdkArch->localVariables),
+        new RemoveDeadStores(rewriteToDpdkArch->localVariables),
     };
 
     dpdk_program = dpdk_program->apply(post_code_gen)->to<IR::DpdkAsmProgram>();
@@ -0,0 +1,619 @@
+#!/usr/bin/env python3
+# Copyright 2021 Intel Corp.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Reference interpreter for the DPDK SWX pipeline specification (.spec)
+# generated by p4c-dpdk. It replays the packets of a pcap file through the
+# pipeline and reports the number of instructions executed per packet, per
+# instruction and per table, so that the generated code can be checked
+# without a DPDK installation.
+#
+# The packet model follows the SWX pipeline: extract reads headers from the
+# current position of the input packet, emit appends a header to the list of
+# output headers, and tx sends the output headers, serialized with their
+# values at that point, followed by the part of the packet that was not
+# extracted.
+
+import argparse
+import re
+import struct
+import sys
+import time
+from collections import OrderedDict
+
+
+class SpecError(Exception):
+    pass
+
+
+class PacketDropped(Exception):
+    pass
+
+
+def parse_int(token):
+    try:
+        return int(token, 0)
+    except ValueError:
+        raise SpecError("invalid number " + token)
+
+
+def mask(width):
+    return (1 << width) - 1
+
+
+def ones_complement_add(a, b):
+    s = a + b
+    return (s & 0xffff) + (s >> 16)
+
+
+def ones_complement_sum(value, width):
+    total = 0
+    while width > 0:
+        total = ones_complement_add(total, value & 0xffff)
+        value >>= 16
+        width -= 16
+    return total
+
+
+class HeaderType(object):
+    def __init__(self, name, fields):
+        self.name = name
+        self.fields = fields        # list of (name, width)
+        self.width = sum(w for _, w in fields)
+
+
+class Instruction(object):
+    def __init__(self, opcode, args, text, block, line):
+        self.opcode = opcode
+        self.args = args
+        self.text = text
+        self.block = block
+        self.line = line
+        self.count = 0
+
+
+class Block(object):
+    """ An action or the apply block: a list of instructions and the index
+        of its labels. """
+    def __init__(self, name, arg_type=None):
+        self.name = name
+        self.arg_type = arg_type
+        self.instructions = []
+        self.labels = {}
+
+
+class Table(object):
+    def __init__(self, name):
+        self.name = name
+        self.keys = []              # list of (operand, match kind)
+        self.actions = []
+        self.default_action = None
+        self.default_args = {}
+        self.size = 0
+        self.exact = {}
+        self.entries = []           # (priority, order, values, masks, prefix, action, args)
+        self.lookups = 0
+        self.hits = 0
+        self.action_counts = OrderedDict()
+
+
+class Spec(object):
+    def __init__(self, filename):
+        self.structs = OrderedDict()
+        self.headers = OrderedDict()    # header instance -> HeaderType
+        self.metadata = None
+        self.actions = OrderedDict()
+        self.tables = OrderedDict()
+        self.registers = OrderedDict()
+        self.meters = OrderedDict()
+        self.apply = None
+        with open(filename) as f:
+            self.lines = f.read().split("\n")
+        self.parse()
+
+    def parse(self):
+        i = 0
+        while i < len(self.lines):
+            line = self.lines[i].strip()
+            words = line.split()
+            if not words:
+                i += 1
+                continue
+            if words[0] == "struct" and line.endswith("{"):
+                i = self.parse_struct(words[1], i + 1)
+            elif words[0] == "header" and len(words) == 4:
+                self.headers[words[1]] = words[3]
+                i += 1
+            elif words[0] == "metadata" and len(words) == 3:
+                self.metadata = words[2]
+                i += 1
+            elif words[0] == "action" and line.endswith("{"):
+                arg_type = words[4] if words[3] == "instanceof" else None
+                block = Block(words[1], arg_type)
+                i = self.parse_block(block, i + 1)
+                self.actions[block.name] = block
+            elif words[0] == "table" and line.endswith("{"):
+                i = self.parse_table(words[1], i + 1)
+            elif words[0] == "apply" and line.endswith("{"):
+                self.apply = Block("apply")
+                i = self.parse_block(self.apply, i + 1)
+            elif words[0] == "regarray":
+                size = parse_int(words[3])
+                self.registers[words[1]] = [parse_int(words[5])] * size
+                i += 1
+            elif words[0] == "metarray":
+                self.meters[words[1]] = parse_int(words[3])
+                i += 1
+            else:
+                raise SpecError("line %d: unsupported declaration: %s" % (i + 1, line))
+        for name, type_name in self.headers.items():
+            if type_name not in self.structs:
+                raise SpecError("unknown type %s of header %s" % (type_name, name))
+            fields = self.structs[type_name]
+            self.headers[name] = HeaderType(type_name, fields)
+        if self.metadata is None or self.metadata not in self.structs:
+            raise SpecError("no metadata structure")
+        if self.apply is None:
+            raise SpecError("no apply block")
+
+    def parse_struct(self, name, i):
+        fields = []
+        while self.lines[i].strip() != "}":
+            m = re.match(r"bit<(\d+)> (\w+)$", self.lines[i].strip())
+            if not m:
+                raise SpecError("line %d: unsupported field: %s" % (i + 1, self.lines[i]))
+            fields.append((m.group(2), int(m.group(1))))
+            i += 1
+        self.structs[name] = fields
+        return i + 1
+
+    def parse_block(self, block, i):
+        while self.lines[i].strip() != "}":
+            text = self.lines[i].strip()
+            # A label is printed on the line of the instruction following it
+            while True:
+                m = re.match(r"(\S+) :\s*(.*)$", text)
+                if not m:
+                    break
+                block.labels[m.group(1)] = len(block.instructions)
+                text = m.group(2)
+            if text:
+                words = text.split()
+                block.instructions.append(
+                    Instruction(words[0], words[1:], text, block, i + 1))
+            i += 1
+        return i + 1
+
+    def parse_table(self, name, i):
+        table = Table(name)
+        section = None
+        while self.lines[i].strip() != "}" or section is not None:
+            words = self.lines[i].split()
+            if words == ["}"]:
+                section = None
+            elif words[-1] == "{":
+                section = words[0]
+            elif section == "key":
+                # Selector fields choose a member of an action selector
+                # group; groups are not modeled, the entry gives the action.
+                if words[1] != "selector":
+                    table.keys.append((words[0], words[1]))
+            elif section == "actions":
+                table.actions.append(words[0])
+            elif words[0] == "default_action":
+                table.default_action = words[1]
+                if words[2:] != ["args", "none"]:
+                    raise SpecError("line %d: default action arguments are not supported" %
+                                    (i + 1))
+            elif words[0] == "size":
+                table.size = parse_int(words[1])
+            i += 1
+        self.tables[name] = table
+        return i + 1
+
+
+class Interpreter(object):
+    def __init__(self, spec, port):
+        self.spec = spec
+        self.port = port
+        self.packets = 0
+        self.sent = 0
+        self.dropped = 0
+        self.executed = 0
+        self.output = []
+
+    # Operands
+
+    def field_width(self, operand, state):
+        base, _, field = operand.rpartition(".")
+        if base == "m":
+            return state["mwidth"][field]
+        if base == "t":
+            return state["twidth"][field]
+        if base.startswith("h."):
+            return state["hwidth"][base[2:]][field]
+        raise SpecError("invalid operand " + operand)
+
+    def read(self, operand, state):
+        if operand[0].isdigit():
+            return parse_int(operand)
+        base, _, field = operand.rpartition(".")
+        if base == "m":
+            return state["m"][field]
+        if base == "t":
+            return state["t"][field]
+        if base.startswith("h."):
+            return state["h"][base[2:]][field]
+        raise SpecError("invalid operand " + operand)
+
+    def write(self, operand, value, state):
+        base, _, field = operand.rpartition(".")
+        value &= mask(self.field_width(operand, state))
+        if base == "m":
+            state["m"][field] = value
+        elif base.startswith("h."):
+            state["h"][base[2:]][field] = value
+        else:
+            raise SpecError("cannot write " + operand)
+
+    # Packet I/O
+
+    def header(self, operand):
+        if not operand.startswith("h.") or operand[2:] not in self.spec.headers:
+            raise SpecError("invalid header " + operand)
+        return operand[2:]
+
+    def extract(self, header, state):
+        htype = self.spec.headers[header]
+        size = htype.width // 8
+        data = state["packet"][state["offset"]:state["offset"] + size]
+        if len(data) < size:
+            raise PacketDropped()
+        state["offset"] += size
+        value = int.from_bytes(data, "big")
+        shift = htype.width
+        for name, width in htype.fields:
+            shift -= width
+            state["h"][header][name] = (value >> shift) & mask(width)
+        state["valid"].add(header)
+
+    def serialize(self, header, state):
+        htype = self.spec.headers[header]
+        value = 0
+        for name, width in htype.fields:
+            value = (value << width) | state["h"][header][name]
+        return value.to_bytes(htype.width // 8, "big")
+
+    # Tables
+
+    def lookup(self, table, state):
+        keys = [self.read(k, state) for k, _ in table.keys]
+        table.lookups += 1
+        best = None
+        exact = table.exact.get(tuple(keys))
+        if exact is not None:
+            best = exact
+        else:
+            for entry in table.entries:
+                _, _, values, masks, prefix, _, _ = entry
+                if all(k & m == v & m for k, v, m in zip(keys, values, masks)):
+                    if best is None or prefix > best[4]:
+                        best = entry
+                    if prefix < 0:
+                        break
+        if best is None:
+            state["hit"] = False
+            return table.default_action, {}
+        state["hit"] = True
+        table.hits += 1
+        return best[5], best[6]
+
+    # Execution
+
+    def run_block(self, block, state):
+        code = block.instructions
+        pc = 0
+        while pc < len(code):
+            instr = code[pc]
+            instr.count += 1
+            self.executed += 1
+            pc += 1
+            op = instr.opcode
+            a = instr.args
+            if op == "mov":
+                self.write(a[0], self.read(a[1], state), state)
+            elif op in ("add", "sub", "and", "or", "xor", "shl", "shr"):
+                x = self.read(a[0], state)
+                y = self.read(a[1], state)
+                self.write(a[0], {
+                    "add": lambda: x + y, "sub": lambda: x - y,
+                    "and": lambda: x & y, "or": lambda: x | y,
+                    "xor": lambda: x ^ y, "shl": lambda: x << y,
+                    "shr": lambda: x >> y}[op](), state)
+            elif op in ("neg", "compl", "lnot"):
+                x = self.read(a[1], state)
+                self.write(a[0], {"neg": -x, "compl": ~x, "lnot": int(x == 0)}[op], state)
+            elif op == "cast":
+                width = int(a[1][len("bit_"):])
+                self.write(a[0], self.read(a[2], state) & mask(width), state)
+            elif op == "jmp":
+                pc = block.labels[a[0]]
+            elif op in ("jmpeq", "jmpneq", "jmplt", "jmpgt", "jmple", "jmpge"):
+                x = self.read(a[1], state)
+                y = self.read(a[2], state)
+                taken = {"jmpeq": x == y, "jmpneq": x != y, "jmplt": x < y,
+                         "jmpgt": x > y, "jmple": x <= y, "jmpge": x >= y}[op]
+                if taken:
+                    pc = block.labels[a[0]]
+            elif op in ("jmpv", "jmpnv"):
+                valid = self.header(a[1]) in state["valid"]
+                if valid == (op == "jmpv"):
+                    pc = block.labels[a[0]]
+            elif op in ("jmph", "jmpnh"):
+                if state["hit"] == (op == "jmph"):
+                    pc = block.labels[a[0]]
+            elif op == "extract":
+                self.extract(self.header(a[0]), state)
+            elif op == "emit":
+                state["emitted"].append(self.header(a[0]))
+            elif op == "validate":
+                state["valid"].add(self.header(a[0]))
+            elif op == "invalidate":
+                state["valid"].discard(self.header(a[0]))
+            elif op == "table":
+                table = self.spec.tables[a[0]]
+                action, args = self.lookup(table, state)
+                table.action_counts[action] = table.action_counts.get(action, 0) + 1
+                self.run_action(action, args, state)
+            elif op == "rx":
+                self.write(a[0], self.port, state)
+            elif op == "tx":
+                return self.read(a[0], state)
+            elif op == "drop":
+                raise PacketDropped()
+            elif op == "return":
+                return None
+            elif op in ("ckadd", "cksub"):
+                checksum = self.read(a[0], state)
+                if a[1][2:] in self.spec.headers:
+                    data = self.serialize(a[1][2:], state)
+                    value = ones_complement_sum(int.from_bytes(data, "big"), len(data) * 8)
+                else:
+                    value = ones_complement_sum(self.read(a[1], state),
+                                                self.field_width(a[1], state))
+                total = ~checksum & 0xffff
+                if op == "ckadd":
+                    total = ones_complement_add(total, value)
+                else:
+                    total = ones_complement_add(total, ~value & 0xffff)
+                self.write(a[0], ~total & 0xffff, state)
+            elif op == "regrd":
+                reg = self.spec.registers[a[1]]
+                self.write(a[0], reg[self.read(a[2], state) % len(reg)], state)
+            elif op in ("regwr", "regadd"):
+                reg = self.spec.registers[a[0]]
+                index = self.read(a[1], state) % len(reg)
+                value = self.read(a[2], state)
+                reg[index] = value if op == "regwr" else reg[index] + value
+            elif op == "meter":
+                # Meters never change the color of a packet
+                self.write(a[4], self.read(a[3], state), state)
+            elif op == "meter_execute":
+                pass
+            else:
+                raise SpecError("line %d: unsupported instruction: %s" %
+                                (instr.line, instr.text))
+        return None
+
+    def run_action(self, name, args, state):
+        block = self.spec.actions[name]
+        saved = state["t"], state["twidth"]
+        state["t"] = args
+        state["twidth"] = OrderedDict(self.spec.structs.get(block.arg_type, []))
+        self.run_block(block, state)
+        state["t"], state["twidth"] = saved
+
+    def process(self, packet):
+        spec = self.spec
+        meta = spec.structs[spec.metadata]
+        state = {
+            "packet": packet,
+            "offset": 0,
+            "m": dict((name, 0) for name, _ in meta),
+            "mwidth": dict(meta),
+            "h": dict((h, dict((f, 0) for f, _ in t.fields))
+                      for h, t in spec.headers.items()),
+            "hwidth": dict((h, dict(t.fields)) for h, t in spec.headers.items()),
+            "t": {},
+            "twidth": {},
+            "valid": set(),
+            "emitted": [],
+            "hit": False,
+        }
+        self.packets += 1
+        try:
+            port = self.run_block(spec.apply, state)
+        except PacketDropped:
+            port = None
+        if port is None:
+            self.dropped += 1
+            return None
+        data = b"".join(self.serialize(h, state) for h in state["emitted"]
+                        if h in state["valid"])
+        self.sent += 1
+        return port, data + packet[state["offset"]:]
+
+
+def load_entries(spec, table_name, filename):
+    """ Reads table entries in the format of the DPDK pipeline CLI:
+        match <key>... [priority <n>] action <name> [<arg> <value>]...
+        Keys of lpm and wildcard fields are written <value>/<mask>, and
+        lpm ones also <value>/<prefix length>. Among the matching wildcard
+        entries the one with the lowest priority value wins, and the first
+        one in the file among equal priorities. """
+    if table_name not in spec.tables:
+        raise SpecError("unknown table " + table_name)
+    table = spec.tables[table_name]
+    interp = Interpreter(spec, 0)
+    state = {"mwidth": dict(spec.structs[spec.metadata]),
+             "hwidth": dict((h, dict(t.fields)) for h, t in spec.headers.items())}
+    kinds = [k for _, k in table.keys]
+    has_lpm = "lpm" in kinds
+    with open(filename) as f:
+        for number, line in enumerate(f, 1):
+            words = line.split("#")[0].split()
+            if not words:
+                continue
+            try:
+                action_at = words.index("action")
+            except ValueError:
+                raise SpecError("%s:%d: missing action" % (filename, number))
+            if words[0] != "match" and table.keys:
+                raise SpecError("%s:%d: missing match" % (filename, number))
+            match = words[1:action_at] if table.keys else []
+            priority = 0
+            if len(match) >= 2 and match[-2] == "priority":
+                priority = parse_int(match[-1])
+                match = match[:-2]
+            if len(match) != len(table.keys):
+                raise SpecError("%s:%d: expected %d key fields" %
+                                (filename, number, len(table.keys)))
+            values, masks, prefix = [], [], 0
+            for (operand, kind), token in zip(table.keys, match):
+                width = interp.field_width(operand, state)
+                value, _, m = token.partition("/")
+                value = parse_int(value)
+                if not m:
+                    m = mask(width)
+                elif kind == "lpm" and not m.startswith("0x"):
+                    length = parse_int(m)
+                    m = mask(width) ^ mask(width - length)
+                else:
+                    m = parse_int(m)
+                if kind == "lpm":
+                    prefix = bin(m).count("1")
+                values.append(value & m)
+                masks.append(m)
+            action = words[action_at + 1]
+            if action not in table.actions:
+                raise SpecError("%s:%d: action %s is not an action of table %s" %
+                                (filename, number, action, table_name))
+            arg_words = words[action_at + 2:]
+            args = {}
+            for i in range(0, len(arg_words), 2):
+                args[arg_words[i]] = parse_int(arg_words[i + 1])
+            if all(k == "exact" for k in kinds):
+                table.exact[tuple(values)] = (0, number, values, masks, 0, action, args)
+            else:
+                # Wildcard entries are kept sorted by priority; the lookup
+                # stops at the first match when no key is lpm.
+                table.entries.append((priority, number, values, masks,
+                                      prefix if has_lpm else -1, action, args))
+    table.entries.sort(key=lambda e: (e[0], e[1]))
+
+
+def read_pcap(filename):
+    with open(filename, "rb") as f:
+        header = f.read(24)
+        if len(header) < 24:
+            raise SpecError(filename + " is not a pcap file")
+        magic = struct.unpack("<I", header[:4])[0]
+        if magic in (0xa1b2c3d4, 0xa1b23c4d):
+            endian = "<"
+        elif magic in (0xd4c3b2a1, 0x4d3cb2a1):
+            endian = ">"
+        else:
+            raise SpecError(filename + " is not a pcap file")
+        packets = []
+        while True:
+            record = f.read(16)
+            if len(record) < 16:
+                break
+            _, _, caplen, _ = struct.unpack(endian + "IIII", record)
+            packets.append(f.read(caplen))
+        return packets
+
+
+def write_pcap(filename, packets):
+    with open(filename, "wb") as f:
+        f.write(struct.pack("<IHHiIII", 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+        for data in packets:
+            f.write(struct.pack("<IIII", 0, 0, len(data), len(data)))
+            f.write(data)
+
+
+def report(interp, spec, elapsed, out):
+    packets = max(interp.packets, 1)
+    out.write("Packets: %d received, %d sent, %d dropped\n" %
+              (interp.packets, interp.sent, interp.dropped))
+    out.write("Instructions: %d executed, %.2f per packet\n" %
+              (interp.executed, interp.executed / float(packets)))
+    if elapsed > 0:
+        out.write("Throughput: %.0f packets/s\n" % (interp.packets / elapsed))
+    out.write("\nInstruction counts:\n")
+    blocks = list(spec.actions.values()) + [spec.apply]
+    for block in blocks:
+        for instr in block.instructions:
+            out.write("%10d  %s:%d\t%s\n" % (instr.count, block.name, instr.line, instr.text))
+    if spec.tables:
+        out.write("\nTable counts:\n")
+    for table in spec.tables.values():
+        out.write("%10d  %s: %d hits, %d misses\n" %
+                  (table.lookups, table.name, table.hits, table.lookups - table.hits))
+        for action, count in table.action_counts.items():
+            out.write("%10d    %s\n" % (count, action))
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(
+        description="Runs the packets of a pcap file through a DPDK pipeline "
+                    "specification generated by p4c-dpdk and reports execution counts.")
+    parser.add_argument("spec", help="pipeline specification (.spec)")
+    parser.add_argument("pcap", help="input packets")
+    parser.add_argument("-t", "--table", action="append", default=[], metavar="TABLE=FILE",
+                        help="load the entries of TABLE from FILE")
+    parser.add_argument("-p", "--port", type=int, default=0,
+                        help="input port of the packets (default: 0)")
+    parser.add_argument("-o", "--output", metavar="PCAP",
+                        help="write the packets sent to PCAP")
+    parser.add_argument("-r", "--repeat", type=int, default=1,
+                        help="replay the input N times (default: 1)")
+    args = parser.parse_args(argv[1:])
+
+    try:
+        spec = Spec(args.spec)
+        for t in args.table:
+            name, _, filename = t.partition("=")
+            load_entries(spec, name, filename)
+        packets = read_pcap(args.pcap)
+        interp = Interpreter(spec, args.port)
+        sent = []
+        start = time.time()
+        for _ in range(args.repeat):
+            for packet in packets:
+                result = interp.process(packet)
+                if result is not None:
+                    sent.append(result[1])
+        elapsed = time.time() - start
+    except (SpecError, IOError) as e:
+        sys.stderr.write("Error: %s\n" % e)
+        return 1
+    if args.output:
+        write_pcap(args.output, sent)
+    report(interp, spec, elapsed, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
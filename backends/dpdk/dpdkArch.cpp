@@ -23,6 +23,9 @@ limitations under the License.
  * We need to convert psa control blocks to this form.
  */
 
+#include <algorithm>
+#include <deque>
+
 #include "dpdkArch.h"
 
 namespace DPDK {
@@ -813,6 +816,7 @@ const IR::Node *CollectLocalVariableToMetadata::postorder(IR::Type_Struct *s) {
                 if (auto dv = d->to<IR::Declaration_Variable>()) {
                     s->fields.push_back(new IR::StructField(
                         IR::ID(kv.first + "_" + dv->name.name), dv->type));
+                    local_variables.insert(kv.first + "_" + dv->name.name);
                 } else if (!d->is<IR::P4Action>() && !d->is<IR::P4Table>() &&
                            !d->is<IR::Declaration_Instance>()) {
                     BUG("%1%: Unhandled declaration type", s);
@@ -868,6 +872,300 @@ const IR::Node *CollectLocalVariableToMetadata::postorder(IR::P4Parser *p) {
     return p;
 }
 
+bool CollectTableKeys::preorder(const IR::P4Program *p) {
+    for (auto obj : p->objects) {
+        if (auto s = obj->to<IR::Type_Struct>()) {
+            if (s->name.name == info->local_metadata_type)
+                metadata = s;
+        }
+    }
+    return true;
+}
+
+const IR::Type_Bits *CollectTableKeys::fieldType(const IR::Member *m) const {
+    if (auto type = m->type->to<IR::Type_Bits>())
+        return type;
+    // Members created for local variables are not type checked yet.
+    auto path = m->expr->to<IR::PathExpression>();
+    if (path && path->path->name.name == "m" && metadata) {
+        if (auto f = metadata->getField(m->member.name))
+            return f->type->to<IR::Type_Bits>();
+    }
+    return nullptr;
+}
+
+bool CollectTableKeys::isAdjacent(const std::vector<const IR::Expression *> &fields) const {
+    auto base = fields.front()->to<IR::Member>()->expr;
+    const IR::Type_StructLike *type = base->type->to<IR::Type_Header>();
+    auto path = base->to<IR::PathExpression>();
+    if (path && path->path->name.name == "m")
+        type = metadata;
+    if (!type)
+        return false;
+    // Local variables are moved to the end of the metadata when packed.
+    std::vector<cstring> order;
+    for (auto f : type->fields) {
+        if (type != metadata || !locals->count(f->name.name))
+            order.push_back(f->name.name);
+    }
+    auto first = fields.front()->to<IR::Member>()->member.name;
+    auto it = std::find(order.begin(), order.end(), first);
+    for (auto e : fields) {
+        auto m = e->to<IR::Member>();
+        if (it == order.end() || *it != m->member.name ||
+            m->expr->toString() != base->toString())
+            return false;
+        ++it;
+    }
+    return true;
+}
+
+bool CollectTableKeys::preorder(const IR::P4Table *t) {
+    auto control = findContext<IR::P4Control>();
+    auto key = t->getKey();
+    if (!control || !key)
+        return false;
+    TableKey table;
+    table.control = control->name.name;
+    table.name = t->name.name;
+    for (auto k : key->keyElements) {
+        // Selector fields are hashed by the action selector, not looked up.
+        if (k->matchType->path->name.name == "selector")
+            continue;
+        auto m = k->expression->to<IR::Member>();
+        auto type = m ? fieldType(m) : nullptr;
+        if (!type)
+            return false;
+        table.fields.push_back(k->expression);
+        table.types.push_back(type);
+    }
+    if (table.fields.size() > 1 && !isAdjacent(table.fields))
+        tables.push_back(table);
+    return false;
+}
+
+// Keys are only copied before a statement t.apply() and before an if
+// statement whose condition is t.apply().hit or t.apply().miss, possibly
+// negated; tables applied anywhere else, e.g. in a switch statement, keep
+// their original key.
+bool CollectTableKeys::preorder(const IR::MethodCallExpression *mce) {
+    auto method = mce->method->to<IR::Member>();
+    if (!method || method->member.name != IR::IApply::applyMethodName)
+        return true;
+    auto path = method->expr->to<IR::PathExpression>();
+    auto control = findContext<IR::P4Control>();
+    if (!path || !control)
+        return true;
+    const IR::Node *child = mce;
+    auto ctxt = getContext();
+    while (ctxt && (ctxt->node->is<IR::Member>() || ctxt->node->is<IR::LNot>())) {
+        child = ctxt->node;
+        ctxt = ctxt->parent;
+    }
+    bool supported = false;
+    if (ctxt) {
+        if (auto mcs = ctxt->node->to<IR::MethodCallStatement>())
+            supported = mcs->methodCall == child;
+        else if (auto ifs = ctxt->node->to<IR::IfStatement>())
+            supported = ifs->condition == child;
+    }
+    if (!supported)
+        unsupported.emplace(control->name.name, path->path->name.name);
+    return true;
+}
+
+void CollectTableKeys::end_apply() {
+    for (auto it = tables.begin(); it != tables.end(); ) {
+        if (unsupported.count(std::make_pair(it->control, it->name))) {
+            LOG2("Table " << it->name << " keeps its key, as it is applied where "
+                 "the key cannot be copied");
+            it = tables.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::stable_sort(tables.begin(), tables.end(),
+                     [](const TableKey &a, const TableKey &b) {
+                         return a.fields.size() > b.fields.size(); });
+    // A slot is one field of a region; its key is the expression it holds.
+    std::vector<cstring> slotKeys;
+    std::vector<const IR::Type_Bits *> slotTypes;
+    std::vector<cstring> slotBases;
+    std::vector<std::deque<int>> regions;
+    for (auto &table : tables) {
+        std::vector<cstring> key;
+        for (auto e : table.fields)
+            key.push_back(e->toString());
+        size_t n = key.size();
+        auto newSlot = [&](size_t i) {
+            auto name = key[i];
+            if (name.startsWith("h.") || name.startsWith("m."))
+                name = name.substr(2);
+            slotKeys.push_back(key[i]);
+            slotTypes.push_back(table.types[i]);
+            slotBases.push_back(table.name + "_" + name.replace('.', '_'));
+            return static_cast<int>(slotKeys.size() - 1);
+        };
+        // Reuse a region containing the key as a run of slots.
+        for (auto &region : regions) {
+            for (size_t start = 0; start + n <= region.size() && table.slots.empty(); start++) {
+                size_t i = 0;
+                while (i < n && slotKeys[region[start + i]] == key[i])
+                    i++;
+                if (i == n)
+                    table.slots.assign(region.begin() + start, region.begin() + start + n);
+            }
+        }
+        if (!table.slots.empty())
+            continue;
+        // Otherwise extend the region overlapping the most with an end of the key.
+        std::deque<int> *best = nullptr;
+        size_t overlap = 0;
+        bool append = true;
+        for (auto &region : regions) {
+            for (size_t k = std::min(n - 1, region.size()); k > overlap; k--) {
+                bool suffix = true, prefix = true;
+                for (size_t i = 0; i < k; i++) {
+                    suffix = suffix && slotKeys[region[region.size() - k + i]] == key[i];
+                    prefix = prefix && slotKeys[region[i]] == key[n - k + i];
+                }
+                if (suffix || prefix) {
+                    best = &region;
+                    overlap = k;
+                    append = suffix;
+                    break;
+                }
+            }
+        }
+        if (!best) {
+            regions.emplace_back();
+            best = &regions.back();
+        }
+        if (append) {
+            std::vector<int> slots(best->end() - overlap, best->end());
+            for (size_t i = overlap; i < n; i++) {
+                slots.push_back(newSlot(i));
+                best->push_back(slots.back());
+            }
+            table.slots = slots;
+        } else {
+            std::vector<int> slots(best->begin(), best->begin() + overlap);
+            for (size_t i = n - overlap; i-- > 0; ) {
+                slots.insert(slots.begin(), newSlot(i));
+                best->push_front(slots.front());
+            }
+            table.slots = slots;
+        }
+    }
+
+    std::set<cstring> used;
+    if (metadata) {
+        for (auto f : metadata->fields)
+            used.insert(f->name.name);
+    }
+    std::vector<cstring> slotNames;
+    for (auto base : slotBases) {
+        slotNames.push_back(cstring::make_unique(used, base, '_'));
+        used.insert(slotNames.back());
+    }
+    unsigned offset = 0;
+    for (auto &region : regions) {
+        if (offset % 8) {
+            auto pad = cstring::make_unique(used, "key_pad", '_');
+            used.insert(pad);
+            fields.push_back(new IR::StructField(
+                IR::ID(pad), IR::Type_Bits::get((8 - offset % 8) * 8)));
+            offset += 8 - offset % 8;
+        }
+        for (auto s : region) {
+            fields.push_back(new IR::StructField(IR::ID(slotNames[s]), slotTypes[s]));
+            offset += (slotTypes[s]->width_bits() + 7) / 8;
+        }
+    }
+    for (auto &table : tables) {
+        auto &key = table_keys[std::make_pair(table.control, table.name)];
+        for (size_t i = 0; i < table.slots.size(); i++)
+            key.emplace_back(slotNames[table.slots[i]], table.fields[i]);
+        LOG2("Table " << table.name << " looks up a contiguous key at "
+             << key.front().first);
+    }
+}
+
+const IR::Node *CopyTableKeysToMetadata::postorder(IR::Type_Struct *s) {
+    if (s->name.name == info->local_metadata_type)
+        s->fields.prepend(keys->fields);
+    return s;
+}
+
+const IR::Node *CopyTableKeysToMetadata::postorder(IR::Key *k) {
+    auto control = findContext<IR::P4Control>();
+    auto table = findContext<IR::P4Table>();
+    if (!control || !table)
+        return k;
+    auto it = keys->table_keys.find(std::make_pair(control->name.name, table->name.name));
+    if (it == keys->table_keys.end())
+        return k;
+    IR::Vector<IR::KeyElement> elements;
+    size_t i = 0;
+    for (auto e : k->keyElements) {
+        if (e->matchType->path->name.name != "selector") {
+            auto slot = new IR::Member(new IR::PathExpression(IR::ID("m")),
+                                       IR::ID(it->second.at(i++).first));
+            e = new IR::KeyElement(e->srcInfo, e->annotations, slot, e->matchType);
+        }
+        elements.push_back(e);
+    }
+    k->keyElements = elements;
+    return k;
+}
+
+// The frontend leaves a table application in a statement only as t.apply(),
+// t.apply().hit or t.apply().miss, the latter possibly negated.
+const std::vector<std::pair<cstring, const IR::Expression *>> *
+CopyTableKeysToMetadata::appliedTable(const IR::Expression *e) {
+    if (auto lnot = e->to<IR::LNot>())
+        return appliedTable(lnot->expr);
+    if (auto m = e->to<IR::Member>())
+        return appliedTable(m->expr);
+    auto mce = e->to<IR::MethodCallExpression>();
+    if (!mce)
+        return nullptr;
+    auto method = mce->method->to<IR::Member>();
+    if (!method || method->member.name != IR::IApply::applyMethodName)
+        return nullptr;
+    auto path = method->expr->to<IR::PathExpression>();
+    auto control = findContext<IR::P4Control>();
+    if (!path || !control)
+        return nullptr;
+    auto it = keys->table_keys.find(std::make_pair(control->name.name, path->path->name.name));
+    if (it == keys->table_keys.end())
+        return nullptr;
+    return &it->second;
+}
+
+const IR::Node *CopyTableKeysToMetadata::copyKeys(const IR::Statement *s,
+                                                  const IR::Expression *e) {
+    auto key = appliedTable(e);
+    if (!key)
+        return s;
+    IR::IndexedVector<IR::StatOrDecl> code_block;
+    for (auto &f : *key) {
+        code_block.push_back(new IR::AssignmentStatement(
+            new IR::Member(new IR::PathExpression(IR::ID("m")), IR::ID(f.first)),
+            f.second));
+    }
+    code_block.push_back(s);
+    return new IR::BlockStatement(code_block);
+}
+
+const IR::Node *CopyTableKeysToMetadata::postorder(IR::MethodCallStatement *s) {
+    return copyKeys(s, s->methodCall);
+}
+
+const IR::Node *CopyTableKeysToMetadata::postorder(IR::IfStatement *s) {
+    return copyKeys(s, s->condition);
+}
+
 const IR::Node *PrependPDotToActionArgs::postorder(IR::P4Action *a) {
     if (a->parameters->size() > 0) {
         auto l = new IR::IndexedVector<IR::Parameter>;
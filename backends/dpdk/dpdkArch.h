@@ -322,6 +322,8 @@ class CollectLocalVariableToMetadata : public Transform {
     P4::ReferenceMap *refMap;
 
   public:
+    // Names of the metadata fields holding local variables.
+    std::set<cstring> local_variables;
     CollectLocalVariableToMetadata(BlockInfoMapping *toBlockInfo,
                                    CollectMetadataHeaderInfo *info,
                                    P4::ReferenceMap *refMap)
@@ -333,6 +335,76 @@ class CollectLocalVariableToMetadata : public Transform {
     const IR::Node *postorder(IR::P4Parser *p) override;
 };
 
+// The key fields of a table are scattered over headers and metadata, and
+// the dpdk runtime has to gather them for every lookup. This pass collects
+// the lookup fields of every table whose key is not already a run of
+// adjacent header fields, and lays them out in contiguous regions of
+// metadata fields. Tables are laid out largest key first, so that a table
+// whose key is a run of an existing region, or overlaps one of its ends,
+// shares that region. Each region starts on an 8-byte boundary.
+class CollectTableKeys : public Inspector {
+    CollectMetadataHeaderInfo *info;
+    const std::set<cstring> *locals;
+    const IR::Type_Struct *metadata = nullptr;
+
+    struct TableKey {
+        cstring control;
+        cstring name;
+        std::vector<const IR::Expression *> fields;
+        std::vector<const IR::Type_Bits *> types;
+        std::vector<int> slots;
+    };
+    std::vector<TableKey> tables;
+    // Tables applied where their keys cannot be copied, by control and table name.
+    std::set<std::pair<cstring, cstring>> unsupported;
+
+    const IR::Type_Bits *fieldType(const IR::Member *m) const;
+    bool isAdjacent(const std::vector<const IR::Expression *> &fields) const;
+
+  public:
+    // Key fields of each table, indexed by control name and table name.
+    std::map<std::pair<cstring, cstring>,
+             std::vector<std::pair<cstring, const IR::Expression *>>> table_keys;
+    // Metadata fields holding the key regions, padding included.
+    IR::IndexedVector<IR::StructField> fields;
+
+    CollectTableKeys(CollectMetadataHeaderInfo *info, const std::set<cstring> *locals)
+        : info(info), locals(locals) {}
+    bool preorder(const IR::P4Program *p) override;
+    bool preorder(const IR::P4Table *t) override;
+    bool preorder(const IR::MethodCallExpression *mce) override;
+    void end_apply() override;
+};
+
+// Inserts the key regions at the start of the metadata struct, copies the
+// key fields of a table to its region before the table is applied, and
+// makes the table match on the region.
+class CopyTableKeysToMetadata : public Transform {
+    CollectMetadataHeaderInfo *info;
+    CollectTableKeys *keys;
+
+    const std::vector<std::pair<cstring, const IR::Expression *>> *
+    appliedTable(const IR::Expression *e);
+    const IR::Node *copyKeys(const IR::Statement *s, const IR::Expression *e);
+
+  public:
+    CopyTableKeysToMetadata(CollectMetadataHeaderInfo *info, CollectTableKeys *keys)
+        : info(info), keys(keys) {}
+    const IR::Node *postorder(IR::Type_Struct *s) override;
+    const IR::Node *postorder(IR::Key *k) override;
+    const IR::Node *postorder(IR::MethodCallStatement *s) override;
+    const IR::Node *postorder(IR::IfStatement *s) override;
+};
+
+class LayoutTableKeys : public PassManager {
+  public:
+    LayoutTableKeys(CollectMetadataHeaderInfo *info, const std::set<cstring> *locals) {
+        auto collect = new CollectTableKeys(info, locals);
+        passes.push_back(collect);
+        passes.push_back(new CopyTableKeysToMetadata(info, collect));
+    }
+};
+
 // According to dpdk spec, action parameters should prepend a p. In order to
 // respect this, we need at first make all action parameter lists into separate
 // structs and declare that struct in the P4 program. Then we modify the action
@@ -590,6 +662,7 @@ class RewriteToDpdkArch : public PassManager {
         *args_struct_map;
     std::map<const IR::Declaration_Instance *, cstring> *csum_map;
     std::vector<const IR::Declaration_Instance *> *externDecls;
+    std::set<cstring> *localVariables;
     RewriteToDpdkArch(P4::ReferenceMap *refMap, P4::TypeMap *typeMap,
                       DpdkVariableCollector *collector) {
         setName("RewriteToDpdkArch");
@@ -628,8 +701,11 @@ class RewriteToDpdkArch : public PassManager {
                 return; }
             main->apply(*parsePsa);
         }));
-        passes.push_back(new CollectLocalVariableToMetadata(
-            &parsePsa->toBlockInfo, info, refMap));
+        auto collectLocals = new CollectLocalVariableToMetadata(
+            &parsePsa->toBlockInfo, info, refMap);
+        localVariables = &collectLocals->local_variables;
+        passes.push_back(collectLocals);
+        passes.push_back(new LayoutTableKeys(info, localVariables));
         auto checksum_convertor = new ConvertInternetChecksum(typeMap, info);
         passes.push_back(checksum_convertor);
         csum_map = &checksum_convertor->csum_map;
@@ -17,6 +17,77 @@ limitations under the License.
 #include "dpdkAsmOpt.h"
 
 namespace DPDK {
+
+namespace {
+
+// Statements that only read and write their explicit operands.
+bool isAluStatement(const IR::DpdkAsmStatement *s) {
+    return s->is<IR::DpdkUnaryStatement>() || s->is<IR::DpdkBinaryStatement>();
+}
+
+bool sameWidth(const IR::Expression *a, const IR::Expression *b) {
+    if (a->type->is<IR::Type_Boolean>() && b->type->is<IR::Type_Boolean>())
+        return true;
+    auto ta = a->type->to<IR::Type_Bits>();
+    auto tb = b->type->to<IR::Type_Bits>();
+    return ta && tb && ta->width_bits() == tb->width_bits();
+}
+
+// Returns the name of the local variable held by e, if any.
+cstring localName(const IR::Expression *e, const std::set<cstring> *locals) {
+    if (auto m = e->to<IR::Member>()) {
+        if (auto path = m->expr->to<IR::PathExpression>()) {
+            if (path->path->name.name == "m" && locals->count(m->member.name))
+                return m->member.name;
+        }
+    }
+    return nullptr;
+}
+
+// Operands are compared by name, which does not depend on their types.
+bool mentions(const IR::DpdkAsmStatement *s, cstring operand) {
+    if (auto un = s->to<IR::DpdkUnaryStatement>())
+        return un->dst->toString() == operand || un->src->toString() == operand;
+    if (auto bin = s->to<IR::DpdkBinaryStatement>())
+        return bin->dst->toString() == operand ||
+               bin->src1->toString() == operand ||
+               bin->src2->toString() == operand;
+    return true;
+}
+
+// Width of a metadata field as laid out by DPDK, 0 if it is not a scalar.
+unsigned fieldWidth(const IR::Type *type) {
+    if (auto t = type->to<IR::Type_Bits>())
+        return t->width_bits();
+    // DPDK implements bool and error as bit<8>
+    if (type->is<IR::Type_Boolean>() || type->is<IR::Type_Error>())
+        return 8;
+    if (auto t = type->to<IR::Type_Name>()) {
+        if (t->path->name == "error")
+            return 8;
+    }
+    return 0;
+}
+
+// Counts the accesses to each local variable.
+class CountLocalVariableAccesses : public Inspector {
+    const std::set<cstring> *locals;
+
+  public:
+    std::map<cstring, unsigned> accesses;
+    explicit CountLocalVariableAccesses(const std::set<cstring> *locals)
+        : locals(locals) {
+        visitDagOnce = false;
+    }
+    bool preorder(const IR::Member *m) override {
+        if (auto name = localName(m, locals))
+            accesses[name]++;
+        return true;
+    }
+};
+
+}  // namespace
+
 // The assumption is compiler can only produce forward jumps.
 const IR::Node *RemoveRedundantLabel::postorder(IR::DpdkListStatement *l) {
     bool changed = false;
@@ -172,4 +243,397 @@ const IR::Node *RemoveLabelAfterLabel::postorder(IR::DpdkListStatement *l) {
     return l;
 }
 
+void CopyPropagation::propagate(
+    IR::IndexedVector<IR::DpdkAsmStatement> &statements) {
+    // Source of the movs of the current basic block, by destination.
+    std::map<cstring, const IR::Expression *> copies;
+    auto replace = [&copies](const IR::Expression *e, bool immediate) {
+        auto it = copies.find(e->toString());
+        if (it == copies.end() ||
+            (!immediate && it->second->is<IR::Constant>()))
+            return e;
+        return it->second;
+    };
+    auto kill = [&copies](const IR::Expression *dst) {
+        cstring operand = dst->toString();
+        copies.erase(operand);
+        for (auto it = copies.begin(); it != copies.end();) {
+            if (it->second->toString() == operand)
+                it = copies.erase(it);
+            else
+                ++it;
+        }
+    };
+    bool changed = false;
+    IR::IndexedVector<IR::DpdkAsmStatement> new_l;
+    for (auto stmt : statements) {
+        if (auto mov = stmt->to<IR::DpdkMovStatement>()) {
+            auto src = replace(mov->src, true);
+            if (src != mov->src) {
+                stmt = new IR::DpdkMovStatement(mov->dst, src);
+                changed = true;
+            }
+            kill(mov->dst);
+            if ((src->is<IR::Member>() || src->is<IR::Constant>()) &&
+                sameWidth(src, mov->dst) &&
+                src->toString() != mov->dst->toString())
+                copies.emplace(mov->dst->toString(), src);
+        } else if (auto un = stmt->to<IR::DpdkUnaryStatement>()) {
+            auto src = replace(un->src, false);
+            if (src != un->src) {
+                auto clone = un->clone();
+                clone->src = src;
+                stmt = clone;
+                changed = true;
+            }
+            kill(un->dst);
+        } else if (auto bin = stmt->to<IR::DpdkBinaryStatement>()) {
+            auto src2 = replace(bin->src2, true);
+            if (src2 != bin->src2) {
+                auto clone = bin->clone();
+                clone->src2 = src2;
+                stmt = clone;
+                changed = true;
+            }
+            kill(bin->dst);
+        } else if (auto jmp = stmt->to<IR::DpdkJmpCondStatement>()) {
+            auto src1 = replace(jmp->src1, false);
+            auto src2 = replace(jmp->src2, true);
+            if (src1 != jmp->src1 || src2 != jmp->src2) {
+                auto clone = jmp->clone();
+                clone->src1 = src1;
+                clone->src2 = src2;
+                stmt = clone;
+                changed = true;
+            }
+            copies.clear();
+        } else {
+            // Labels and jumps end the basic block, and the other
+            // instructions may access fields that are not their operands.
+            copies.clear();
+        }
+        new_l.push_back(stmt);
+    }
+    if (changed)
+        statements = new_l;
+}
+
+const IR::Node *CopyPropagation::postorder(IR::DpdkListStatement *l) {
+    propagate(l->statements);
+    return l;
+}
+
+const IR::Node *CopyPropagation::postorder(IR::DpdkAction *a) {
+    propagate(a->statements);
+    return a;
+}
+
+bool CountLocalVariableReads::preorder(const IR::Member *m) {
+    if (auto name = localName(m, locals))
+        reads[name]++;
+    return true;
+}
+
+bool CountLocalVariableReads::preorder(const IR::DpdkUnaryStatement *s) {
+    visit(s->src);
+    return false;
+}
+
+bool CountLocalVariableReads::preorder(const IR::DpdkBinaryStatement *s) {
+    if (s->src1->toString() != s->dst->toString())
+        visit(s->src1);
+    visit(s->src2);
+    return false;
+}
+
+const IR::Node *RetargetLocalVariables::preorder(IR::DpdkAsmProgram *p) {
+    counter.reads.clear();
+    p->apply(counter);
+    return p;
+}
+
+void RetargetLocalVariables::retarget(
+    IR::IndexedVector<IR::DpdkAsmStatement> &statements) {
+    bool changed = false;
+    std::vector<const IR::DpdkAsmStatement *> stmts(statements.begin(),
+                                                    statements.end());
+    for (size_t i = 0; i < stmts.size(); i++) {
+        auto mov = stmts[i] ? stmts[i]->to<IR::DpdkMovStatement>() : nullptr;
+        if (!mov)
+            continue;
+        cstring local = localName(mov->src, locals);
+        if (!local || counter.reads[local] != 1 ||
+            !sameWidth(mov->src, mov->dst))
+            continue;
+        cstring tmp = mov->src->toString();
+        cstring dst = mov->dst->toString();
+        // Look back for the instructions computing the local variable: a
+        // unary instruction followed by binary ones, within the basic block.
+        std::vector<size_t> chain;
+        bool found = false;
+        for (size_t k = i; k-- > 0 && !found;) {
+            auto stmt = stmts[k];
+            if (!stmt)
+                continue;
+            if (!isAluStatement(stmt) || mentions(stmt, dst))
+                break;
+            auto assign = stmt->to<IR::DpdkAssignmentStatement>();
+            if (assign->dst->toString() != tmp) {
+                if (mentions(stmt, tmp))
+                    break;
+            } else if (auto bin = stmt->to<IR::DpdkBinaryStatement>()) {
+                if (bin->src2->toString() == tmp)
+                    break;
+                chain.push_back(k);
+            } else if (stmt->to<IR::DpdkUnaryStatement>()->src->toString() != tmp) {
+                chain.push_back(k);
+                found = true;
+            } else {
+                break;
+            }
+        }
+        if (!found)
+            continue;
+        for (auto k : chain) {
+            if (auto bin = stmts[k]->to<IR::DpdkBinaryStatement>()) {
+                auto clone = bin->clone();
+                clone->dst = mov->dst;
+                clone->src1 = mov->dst;
+                stmts[k] = clone;
+            } else {
+                auto clone = stmts[k]->to<IR::DpdkUnaryStatement>()->clone();
+                clone->dst = mov->dst;
+                stmts[k] = clone;
+            }
+        }
+        stmts[i] = nullptr;
+        counter.reads[local] = 0;
+        changed = true;
+    }
+    if (!changed)
+        return;
+    IR::IndexedVector<IR::DpdkAsmStatement> new_l;
+    for (auto stmt : stmts) {
+        if (stmt)
+            new_l.push_back(stmt);
+    }
+    statements = new_l;
+}
+
+const IR::Node *RetargetLocalVariables::postorder(IR::DpdkListStatement *l) {
+    retarget(l->statements);
+    return l;
+}
+
+const IR::Node *RetargetLocalVariables::postorder(IR::DpdkAction *a) {
+    retarget(a->statements);
+    return a;
+}
+
+const IR::Node *RemoveDeadStores::preorder(IR::DpdkAsmProgram *p) {
+    counter.reads.clear();
+    p->apply(counter);
+    return p;
+}
+
+void RemoveDeadStores::removeDead(
+    IR::IndexedVector<IR::DpdkAsmStatement> &statements) {
+    bool changed = false;
+    IR::IndexedVector<IR::DpdkAsmStatement> new_l;
+    for (auto stmt : statements) {
+        if (auto mov = stmt->to<IR::DpdkMovStatement>()) {
+            if (mov->dst->toString() == mov->src->toString()) {
+                changed = true;
+                continue;
+            }
+        }
+        if (isAluStatement(stmt)) {
+            auto dst = stmt->to<IR::DpdkAssignmentStatement>()->dst;
+            cstring local = localName(dst, locals);
+            if (local && counter.reads.count(local) == 0) {
+                changed = true;
+                continue;
+            }
+        }
+        new_l.push_back(stmt);
+    }
+    if (changed)
+        statements = new_l;
+}
+
+const IR::Node *RemoveDeadStores::postorder(IR::DpdkListStatement *l) {
+    removeDead(l->statements);
+    return l;
+}
+
+const IR::Node *RemoveDeadStores::postorder(IR::DpdkAction *a) {
+    removeDead(a->statements);
+    return a;
+}
+
+void PackLocalVariables::allocate(const IR::DpdkAsmProgram *p) {
+    CountLocalVariableAccesses total(locals);
+    p->apply(total);
+
+    std::map<cstring, unsigned> width;
+    for (auto st : p->structType) {
+        if (!st->getAnnotations()->getSingle("__metadata__"))
+            continue;
+        for (auto f : st->fields) {
+            if (locals->count(f->name.name))
+                width.emplace(f->name.name, fieldWidth(f->type));
+        }
+    }
+
+    // Accesses of a local variable in the basic block where it is first
+    // accessed. Instructions are numbered across the whole program.
+    struct LiveRange {
+        unsigned block;
+        unsigned start;
+        unsigned end;
+        unsigned accesses;
+        // The first access is an instruction that writes it without reading it.
+        bool defined;
+        // It is accessed in an action rather than in the apply block.
+        bool inAction;
+    };
+    std::map<cstring, LiveRange> ranges;
+    std::set<cstring> escaping;
+    unsigned block = 0;
+    unsigned position = 0;
+    bool inAction = true;
+    auto writes = [this](const IR::DpdkAsmStatement *stmt, cstring local) {
+        const IR::Expression *dst = nullptr;
+        if (auto assign = stmt->to<IR::DpdkAssignmentStatement>())
+            dst = assign->dst;
+        else if (auto cast = stmt->to<IR::DpdkCastStatement>())
+            dst = cast->dst;
+        return dst != nullptr && localName(dst, locals) == local;
+    };
+    auto scan = [&](const IR::IndexedVector<IR::DpdkAsmStatement> &statements) {
+        block++;
+        for (auto stmt : statements) {
+            if (stmt->is<IR::DpdkLabelStatement>())
+                block++;
+            position++;
+            CountLocalVariableAccesses used(locals);
+            stmt->apply(used);
+            for (auto a : used.accesses) {
+                auto it = ranges.find(a.first);
+                if (it == ranges.end()) {
+                    bool defined = a.second == 1 && writes(stmt, a.first);
+                    ranges.emplace(a.first, LiveRange{block, position, position,
+                                                      a.second, defined, inAction});
+                } else if (it->second.block != block) {
+                    escaping.insert(a.first);
+                } else {
+                    it->second.end = position;
+                    it->second.accesses += a.second;
+                }
+            }
+            if (stmt->is<IR::DpdkJmpStatement>())
+                block++;
+        }
+    };
+    for (auto a : p->actions)
+        scan(a->statements);
+    inAction = false;
+    for (auto stmt : p->statements) {
+        if (auto l = stmt->to<IR::DpdkListStatement>())
+            scan(l->statements);
+    }
+
+    std::vector<cstring> candidates;
+    for (auto r : ranges) {
+        cstring local = r.first;
+        if (!escaping.count(local) && r.second.defined &&
+            r.second.accesses == total.accesses[local] && width[local] != 0)
+            candidates.push_back(local);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [&ranges](cstring a, cstring b) {
+                  return ranges.at(a).start < ranges.at(b).start; });
+
+    // An instruction reads its sources before writing its destination, so a
+    // field can be reused by the instruction holding its last access.
+    // Actions are numbered before the apply block, but run in the middle of
+    // it, when a table or learner is applied; an apply block local may be
+    // live across that, so actions and the apply block never share a field.
+    struct Slot {
+        cstring name;
+        unsigned width;
+        unsigned end;
+        bool inAction;
+    };
+    std::vector<Slot> slots;
+    slot.clear();
+    for (auto local : candidates) {
+        auto &range = ranges.at(local);
+        Slot *free = nullptr;
+        for (auto &s : slots) {
+            if (s.width == width[local] && s.inAction == range.inAction &&
+                s.end <= range.start) {
+                free = &s;
+                break;
+            }
+        }
+        if (free) {
+            free->end = range.end;
+            slot.emplace(local, free->name);
+        } else {
+            slots.push_back(Slot{local, width[local], range.end, range.inAction});
+            slot.emplace(local, local);
+        }
+    }
+    accesses.clear();
+    for (auto a : total.accesses) {
+        slot.emplace(a.first, a.first);
+        accesses[slot.at(a.first)] += a.second;
+    }
+}
+
+const IR::Node *PackLocalVariables::preorder(IR::DpdkAsmProgram *p) {
+    allocate(p);
+    return p;
+}
+
+const IR::Node *PackLocalVariables::postorder(IR::DpdkStructType *s) {
+    if (!s->getAnnotations()->getSingle("__metadata__"))
+        return s;
+    unsigned before = 0;
+    unsigned after = 0;
+    IR::IndexedVector<IR::StructField> fields;
+    std::vector<const IR::StructField *> kept;
+    for (auto f : s->fields) {
+        before += (fieldWidth(f->type) + 7) / 8;
+        if (!locals->count(f->name.name)) {
+            fields.push_back(f);
+        } else {
+            auto it = slot.find(f->name.name);
+            if (it != slot.end() && it->second == f->name.name)
+                kept.push_back(f);
+        }
+    }
+    std::stable_sort(kept.begin(), kept.end(),
+                     [this](const IR::StructField *a, const IR::StructField *b) {
+                         return accesses.at(a->name.name) > accesses.at(b->name.name); });
+    for (auto f : kept)
+        fields.push_back(f);
+    for (auto f : fields)
+        after += (fieldWidth(f->type) + 7) / 8;
+    LOG1("Metadata " << s->name << ": " << before << " bytes, " << after
+         << " bytes after packing local variables");
+    s->fields = fields;
+    return s;
+}
+
+const IR::Node *PackLocalVariables::postorder(IR::Member *m) {
+    if (auto local = localName(m, locals)) {
+        auto it = slot.find(local);
+        if (it != slot.end() && it->second != local)
+            m->member = IR::ID(it->second);
+    }
+    return m;
+}
+
 }  // namespace DPDK
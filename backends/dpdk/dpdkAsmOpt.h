@@ -86,10 +86,123 @@ class RemoveLabelAfterLabel : public Transform {
     const IR::Node *postorder(IR::DpdkListStatement *l) override;
 };
 
+// This pass replaces, within a basic block, the reads of the destination of
+// a mov by its source, as long as neither of them is written in between. For
+// example,
+// mov m.Ingress_tmp h.ipv4.ttl
+// jmpeq label1 m.Ingress_tmp 0x0
+//
+// will become:
+// mov m.Ingress_tmp h.ipv4.ttl
+// jmpeq label1 h.ipv4.ttl 0x0
+//
+// Constants are only propagated to the operands that accept an immediate.
+// The mov is left for RemoveDeadStores.
+
+class CopyPropagation : public Transform {
+    void propagate(IR::IndexedVector<IR::DpdkAsmStatement> &statements);
+
+  public:
+    const IR::Node *postorder(IR::DpdkListStatement *l) override;
+    const IR::Node *postorder(IR::DpdkAction *a) override;
+};
+
+// This pass counts how many times each local variable (a metadata field that
+// holds a variable of a control or a parser, see
+// CollectLocalVariableToMetadata) is read in the whole program, including
+// table keys and actions. The destination of a binary operation, which is
+// also its first source, is not counted as read.
+
+class CountLocalVariableReads : public Inspector {
+    const std::set<cstring> *locals;
+
+  public:
+    std::map<cstring, unsigned> reads;
+    explicit CountLocalVariableReads(const std::set<cstring> *locals)
+        : locals(locals) {
+        // Operands may be shared between instructions
+        visitDagOnce = false;
+    }
+    bool preorder(const IR::Member *m) override;
+    bool preorder(const IR::DpdkUnaryStatement *s) override;
+    bool preorder(const IR::DpdkBinaryStatement *s) override;
+};
+
+// This pass computes a value directly into its destination instead of a
+// local variable that is only copied to that destination. For example,
+// mov m.Ingress_tmp h.ipv4.ttl
+// add m.Ingress_tmp 0x1
+// mov h.ipv4.ttl2 m.Ingress_tmp
+//
+// will become:
+// mov h.ipv4.ttl2 h.ipv4.ttl
+// add h.ipv4.ttl2 0x1
+//
+// provided that m.Ingress_tmp is not read anywhere else, and that the
+// destination is not used by the instructions in between.
+
+class RetargetLocalVariables : public Transform {
+    const std::set<cstring> *locals;
+    CountLocalVariableReads counter;
+    void retarget(IR::IndexedVector<IR::DpdkAsmStatement> &statements);
+
+  public:
+    explicit RetargetLocalVariables(const std::set<cstring> *locals)
+        : locals(locals), counter(locals) {}
+    const IR::Node *preorder(IR::DpdkAsmProgram *p) override;
+    const IR::Node *postorder(IR::DpdkListStatement *l) override;
+    const IR::Node *postorder(IR::DpdkAction *a) override;
+};
+
+// This pass removes the mov and ALU instructions writing to a local variable
+// that is never read, as well as the movs of a field into itself.
+
+class RemoveDeadStores : public Transform {
+    const std::set<cstring> *locals;
+    CountLocalVariableReads counter;
+    void removeDead(IR::IndexedVector<IR::DpdkAsmStatement> &statements);
+
+  public:
+    explicit RemoveDeadStores(const std::set<cstring> *locals)
+        : locals(locals), counter(locals) {}
+    const IR::Node *preorder(IR::DpdkAsmProgram *p) override;
+    const IR::Node *postorder(IR::DpdkListStatement *l) override;
+    const IR::Node *postorder(IR::DpdkAction *a) override;
+};
+
+// This pass reduces the size of the metadata structure. A local variable that
+// is only accessed within one basic block, and is first written there by an
+// instruction that does not read it, is live from that instruction to its last
+// access. Local variables of the same width whose live ranges do not overlap
+// share a field, unless one is accessed in an action and the other in the
+// apply block, which runs the actions when it applies a table. The fields of local variables that are not accessed are
+// removed, and the other ones are sorted by decreasing number of accesses, so
+// that the most used ones are close together. The movs of a field into itself
+// that the sharing may create are left for RemoveDeadStores.
+
+class PackLocalVariables : public Transform {
+    const std::set<cstring> *locals;
+    // Field holding each local variable that is still accessed.
+    std::map<cstring, cstring> slot;
+    // Number of accesses to each field.
+    std::map<cstring, unsigned> accesses;
+    void allocate(const IR::DpdkAsmProgram *p);
+
+  public:
+    explicit PackLocalVariables(const std::set<cstring> *locals)
+        : locals(locals) {}
+    const IR::Node *preorder(IR::DpdkAsmProgram *p) override;
+    const IR::Node *postorder(IR::DpdkStructType *s) override;
+    const IR::Node *postorder(IR::Member *m) override;
+};
+
 class DpdkAsmOptimization : public PassRepeated {
   private:
   public:
-    DpdkAsmOptimization() {
+    explicit DpdkAsmOptimization(const std::set<cstring> *locals) {
+        passes.push_back(new CopyPropagation);
+        passes.push_back(new RetargetLocalVariables(locals));
+        passes.push_back(new RemoveDeadStores(locals));
         passes.push_back(new RemoveRedundantLabel);
         auto r = new PassRepeated{new RemoveLabelAfterLabel};
         passes.push_back(r);
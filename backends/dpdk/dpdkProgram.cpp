@@ -94,9 +94,11 @@ const IR::DpdkAsmProgram *ConvertToDpdkProgram::create(IR::P4Program *prog) {
     IR::IndexedVector<IR::DpdkAsmStatement> statements;
 
     auto ingress_parser_converter =
-        new ConvertToDpdkParser(refmap, typemap, collector, csum_map, metadataStruct);
+        new ConvertToDpdkParser(refmap, typemap, collector, csum_map, metadataStruct,
+                                localVariables);
     auto egress_parser_converter =
-        new ConvertToDpdkParser(refmap, typemap, collector, csum_map, metadataStruct);
+        new ConvertToDpdkParser(refmap, typemap, collector, csum_map, metadataStruct,
+                                localVariables);
     for (auto kv : structure.parsers) {
         if (kv.first == "ingress")
             kv.second->apply(*ingress_parser_converter);
@@ -184,6 +186,7 @@ IR::Declaration_Variable *ConvertToDpdkParser::addNewTmpVarToMetadata(cstring na
                                                refmap->newName(name)), type);
     metadataStruct->fields.push_back(new IR::StructField(IR::ID(newTmpVar->name.name),
                                                          newTmpVar->type));
+    localVariables->insert(newTmpVar->name.name);
     return newTmpVar;
 }
 
@@ -259,8 +262,9 @@ bool ConvertToDpdkParser::preorder(const IR::P4Parser *p) {
                             unsigned value = right->to<IR::Constant>()->asUnsigned() &
                                              left->to<IR::Constant>()->asUnsigned();
                             auto tmpDecl = addNewTmpVarToMetadata("tmpMask", switch_var->type);
-                            auto tmpMask = new IR::PathExpression(
-                                               IR::ID("m." + tmpDecl->name.name));
+                            auto tmpMask = new IR::Member(switch_var->type,
+                                               new IR::PathExpression(IR::ID("m")),
+                                               IR::ID(tmpDecl->name.name));
                             collector->push_variable(new IR::DpdkDeclaration(tmpDecl));
                             add_instr(new IR::DpdkMovStatement(tmpMask, switch_var));
                             add_instr(new IR::DpdkAndStatement(tmpMask, tmpMask, right));
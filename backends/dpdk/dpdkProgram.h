@@ -58,6 +58,7 @@ class ConvertToDpdkProgram : public Transform {
         *args_struct_map;
     std::map<const IR::Declaration_Instance *, cstring> *csum_map;
     std::vector<const IR::Declaration_Instance *> *externDecls; 
+    std::set<cstring> *localVariables;
   public:
     ConvertToDpdkProgram(BMV2::PsaProgramStructure &structure,
                          P4::ReferenceMap *refmap, P4::TypeMap *typemap,
@@ -69,6 +70,7 @@ class ConvertToDpdkProgram : public Transform {
         args_struct_map = dpdkarch->args_struct_map;
         csum_map = dpdkarch->csum_map;
         externDecls = dpdkarch->externDecls;
+        localVariables = dpdkarch->localVariables;
     }
 
     const IR::DpdkAsmProgram *create(IR::P4Program *prog);
@@ -90,15 +92,20 @@ class ConvertToDpdkParser : public Inspector {
     std::map<const IR::Declaration_Instance *, cstring> *csum_map;
 
     IR::Type_Struct *metadataStruct;
+    // Metadata fields holding local variables, which includes the
+    // temporaries added by the parser conversion.
+    std::set<cstring> *localVariables;
 
   public:
     ConvertToDpdkParser(
         P4::ReferenceMap *refmap, P4::TypeMap *typemap,
         DpdkVariableCollector *collector,
 
-        std::map<const IR::Declaration_Instance *, cstring> *csum_map, IR::Type_Struct *metadataStruct)
+        std::map<const IR::Declaration_Instance *, cstring> *csum_map, IR::Type_Struct *metadataStruct,
+        std::set<cstring> *localVariables)
         : refmap(refmap), typemap(typemap), collector(collector),
-          csum_map(csum_map), metadataStruct(metadataStruct) {}
+          csum_map(csum_map), metadataStruct(metadataStruct),
+          localVariables(localVariables) {}
     IR::IndexedVector<IR::DpdkAsmStatement> getInstructions() {
         return instructions;
     }
@@ -22,6 +22,7 @@ limitations under the License.
 #include "target.h"
 #include "ebpfType.h"
 #include "ebpfProgram.h"
+#include "ebpfDeparser.h"
 
 namespace EBPF {
 
@@ -45,9 +46,14 @@ void run_ebpf_backend(const EbpfOptions& options, const IR::ToplevelBlock* tople
         target = new BccTarget();
     } else if (options.target == "test") {
         target = new TestTarget();
+    } else if (options.target == "xdp") {
+        target = new XdpTarget();
+    } else if (options.target == "xdp_test") {
+        target = new XdpTestTarget();
     } else {
         ::error(ErrorType::ERR_UNKNOWN,
-                "Unknown target %s; legal choices are 'bcc', 'kernel', and test", options.target);
+                "Unknown target %s; legal choices are 'bcc', 'kernel', 'xdp', "
+                "'xdp_test', and test", options.target);
         return;
     }
 
@@ -58,6 +64,13 @@ void run_ebpf_backend(const EbpfOptions& options, const IR::ToplevelBlock* tople
     auto ebpfprog = new EBPFProgram(options, toplevel->getProgram(), refMap, typeMap, toplevel);
     if (!ebpfprog->build())
         return;
+    if (ebpfprog->deparser != nullptr && !target->directPacketAccess()) {
+        ::error(ErrorType::ERR_UNSUPPORTED_ON_TARGET,
+                "%1%: rewriting headers in place needs direct packet access, "
+                "which target %2% does not have", ebpfprog->deparser->controlBlock->container,
+                options.target);
+        return;
+    }
 
     if (options.outputFile.isNullOrEmpty())
         return;
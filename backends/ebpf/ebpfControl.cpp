@@ -330,19 +330,43 @@ void ControlBodyTranslator::processApply(const P4::ApplyMethod* method) {
         builder->endOfStatement(true);
     }
 
+    auto runAction = [&]() {
+        builder->emitIndent();
+        builder->appendLine("/* run action */");
+        table->emitAction(builder, valueName);
+        if (!actionVariableName.isNullOrEmpty()) {
+            builder->emitIndent();
+            builder->appendFormat("%s = %s->action",
+                                  actionVariableName.c_str(), valueName.c_str());
+            builder->endOfStatement(true);
+        }
+    };
+
+    cstring defaultValueName = "defaultValue";
+    if (table->constDefaultAction)
+        // The default action cannot change at runtime: run it from a
+        // value built on the stack instead of a second map lookup.
+        table->emitDefaultActionValue(builder, defaultValueName);
+
     builder->emitIndent();
     builder->appendFormat("if (%s == NULL) ", valueName.c_str());
     builder->blockStart();
 
     builder->emitIndent();
-    builder->appendLine("/* miss; find default action */");
+    if (table->constDefaultAction)
+        builder->appendLine("/* miss; run const default action */");
+    else
+        builder->appendLine("/* miss; find default action */");
     builder->emitIndent();
     builder->appendFormat("%s = 0", control->hitVariable.c_str());
     builder->endOfStatement(true);
 
     builder->emitIndent();
-    builder->target->emitTableLookup(builder, table->defaultActionMapName,
-                                     control->program->zeroKey, valueName);
+    if (table->constDefaultAction)
+        builder->appendFormat("%s = &%s", valueName.c_str(), defaultValueName.c_str());
+    else
+        builder->target->emitTableLookup(builder, table->defaultActionMapName,
+                                         control->program->zeroKey, valueName);
     builder->endOfStatement(true);
     builder->blockEnd(false);
     builder->append(" else ");
@@ -352,18 +376,17 @@ void ControlBodyTranslator::processApply(const P4::ApplyMethod* method) {
     builder->endOfStatement(true);
     builder->blockEnd(true);
 
+    if (table->constDefaultAction) {
+        runAction();
+        toDereference.clear();
+        builder->blockEnd(true);
+        return;
+    }
+
     builder->emitIndent();
     builder->appendFormat("if (%s != NULL) ", valueName.c_str());
     builder->blockStart();
-    builder->emitIndent();
-    builder->appendLine("/* run action */");
-    table->emitAction(builder, valueName);
-    if (!actionVariableName.isNullOrEmpty()) {
-        builder->emitIndent();
-        builder->appendFormat("%s = %s->action",
-                              actionVariableName.c_str(), valueName.c_str());
-        builder->endOfStatement(true);
-    }
+    runAction();
     toDereference.clear();
 
     builder->blockEnd(true);
@@ -0,0 +1,538 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "ebpfDeparser.h"
+#include "ebpfControl.h"
+#include "ebpfParser.h"
+#include "ebpfType.h"
+#include "frontends/p4/coreLibrary.h"
+#include "frontends/p4/methodInstance.h"
+
+namespace EBPF {
+
+namespace {
+
+/// Root of an l-value such as hdr.ipv4.ttl[3:0].
+const IR::PathExpression* lvalueRoot(const IR::Expression* expr) {
+    while (true) {
+        if (auto mem = expr->to<IR::Member>())
+            expr = mem->expr;
+        else if (auto slice = expr->to<IR::Slice>())
+            expr = slice->e0;
+        else if (auto ai = expr->to<IR::ArrayIndex>())
+            expr = ai->left;
+        else
+            return expr->to<IR::PathExpression>();
+    }
+}
+
+bool isRootedAt(const IR::Expression* expr, const IR::Parameter* root,
+                const P4::ReferenceMap* refMap) {
+    auto pe = lvalueRoot(expr);
+    if (pe == nullptr)
+        return false;
+    return refMap->getDeclaration(pe->path, true)->getNode() == root;
+}
+
+/// Path of a header relative to the headers parameter, e.g. "ipv4" for
+/// hdr.ipv4.  Returns an empty string for headers which are not tracked:
+/// stack elements and members of header unions.
+cstring headerPath(const IR::Expression* expr, const IR::Parameter* root,
+                   const P4::ReferenceMap* refMap, const P4::TypeMap* typeMap) {
+    std::vector<cstring> names;
+    while (auto mem = expr->to<IR::Member>()) {
+        names.push_back(mem->member.name);
+        expr = mem->expr;
+        if (typeMap->getType(expr, true)->is<IR::Type_HeaderUnion>())
+            return cstring();
+    }
+    auto pe = expr->to<IR::PathExpression>();
+    if (pe == nullptr || names.empty() ||
+        refMap->getDeclaration(pe->path, true)->getNode() != root)
+        return cstring();
+    std::string result;
+    for (auto it = names.rbegin(); it != names.rend(); ++it) {
+        if (!result.empty())
+            result += ".";
+        result += it->c_str();
+    }
+    return result;
+}
+
+/// Collects the headers modified by a parser or control block.
+class HeaderWrites : public Inspector {
+    EBPFDeparser*        deparser;
+    const IR::Parameter* headers;
+    P4::ReferenceMap*    refMap;
+    P4::TypeMap*         typeMap;
+
+    void written(const IR::Expression* lvalue, bool validity) {
+        if (!isRootedAt(lvalue, headers, refMap))
+            return;
+        // Find the header containing the l-value, and the field below it.
+        const IR::Expression* expr = lvalue;
+        const IR::Expression* below = nullptr;
+        while (true) {
+            auto type = typeMap->getType(expr, true);
+            if (type->is<IR::Type_Header>())
+                break;
+            if (type->is<IR::Type_Stack>())
+                // Stack elements are not tracked.
+                return;
+            below = expr;
+            if (auto mem = expr->to<IR::Member>()) {
+                expr = mem->expr;
+            } else if (auto slice = expr->to<IR::Slice>()) {
+                expr = slice->e0;
+            } else {
+                // The whole headers structure, or a structure of headers.
+                deparser->allHeadersWritten = true;
+                return;
+            }
+        }
+        cstring path = headerPath(expr, headers, refMap, typeMap);
+        if (path.isNullOrEmpty())
+            return;
+        auto field = below != nullptr ? below->to<IR::Member>() : nullptr;
+        if (validity || field == nullptr)
+            deparser->validityChanged.emplace(path);
+        else
+            deparser->fieldsWritten[path].emplace(field->member.name);
+    }
+
+ public:
+    HeaderWrites(EBPFDeparser* deparser, const IR::Parameter* headers) :
+            deparser(deparser), headers(headers),
+            refMap(deparser->program->refMap), typeMap(deparser->program->typeMap)
+    { setName("HeaderWrites"); }
+
+    bool preorder(const IR::AssignmentStatement* statement) override {
+        written(statement->left, false);
+        return true;
+    }
+    bool preorder(const IR::MethodCallExpression* expression) override {
+        auto mi = P4::MethodInstance::resolve(expression, refMap, typeMap);
+        if (auto bim = mi->to<P4::BuiltInMethod>()) {
+            if (bim->name != IR::Type_Header::isValid)
+                written(bim->appliedTo, true);
+            return true;
+        }
+        if (auto em = mi->to<P4::ExternMethod>()) {
+            // Extracted headers are accounted for by the layout analysis.
+            if (em->originalExternType->name == P4::P4CoreLibrary::instance.packetIn.name)
+                return true;
+        }
+        for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
+            if (p->direction != IR::Direction::Out && p->direction != IR::Direction::InOut)
+                continue;
+            written(mi->substitution.lookup(p)->expression, false);
+        }
+        return true;
+    }
+};
+
+class DeparserTranslationVisitor : public CodeGenInspector {
+ public:
+    DeparserTranslationVisitor(P4::ReferenceMap* refMap, P4::TypeMap* typeMap) :
+            CodeGenInspector(refMap, typeMap) { setName("DeparserTranslationVisitor"); }
+
+    bool preorder(const IR::PathExpression* expression) override {
+        auto decl = refMap->getDeclaration(expression->path, true);
+        if (auto param = decl->getNode()->to<IR::Parameter>()) {
+            auto subst = ::get(substitution, param);
+            if (subst != nullptr) {
+                builder->append(subst->name);
+                return false;
+            }
+        }
+        builder->append(expression->path->name);
+        return false;
+    }
+};
+
+}  // namespace
+
+EBPFDeparser::EBPFDeparser(const EBPFProgram* program, const IR::ControlBlock* block,
+                           const IR::Parameter* parserHeaders) :
+        program(program), controlBlock(block), packet_out(nullptr), headers(nullptr),
+        parserHeaders(parserHeaders), codeGen(nullptr), allHeadersWritten(false) {}
+
+bool EBPFDeparser::build() {
+    auto pl = controlBlock->container->type->applyParams;
+    if (pl->size() != 2) {
+        ::error(ErrorType::ERR_EXPECTED,
+                "%1%: Expected deparser to have exactly 2 parameters", controlBlock->getNode());
+        return false;
+    }
+
+    auto it = pl->parameters.begin();
+    packet_out = *it;
+    ++it;
+    headers = *it;
+
+    codeGen = new DeparserTranslationVisitor(program->refMap, program->typeMap);
+    codeGen->substitute(headers, parserHeaders);
+    outHeaderLengthVar = EBPFModel::reserved("outHeaderLength");
+    headerAdjustVar = EBPFModel::reserved("headerAdjust");
+
+    auto& p4lib = P4::P4CoreLibrary::instance;
+    std::vector<const IR::StatOrDecl*> worklist(controlBlock->container->body->components.begin(),
+                                                controlBlock->container->body->components.end());
+    for (size_t i = 0; i < worklist.size(); i++) {
+        auto s = worklist[i];
+        if (auto block = s->to<IR::BlockStatement>()) {
+            worklist.insert(worklist.begin() + i + 1,
+                            block->components.begin(), block->components.end());
+            continue;
+        }
+        auto mcs = s->to<IR::MethodCallStatement>();
+        if (mcs == nullptr) {
+            ::error(ErrorType::ERR_UNSUPPORTED_ON_TARGET, "%1%: not supported in deparser", s);
+            return false;
+        }
+        auto mi = P4::MethodInstance::resolve(mcs->methodCall, program->refMap, program->typeMap);
+        auto em = mi->to<P4::ExternMethod>();
+        if (em == nullptr || em->object != packet_out ||
+            em->method->name.name != p4lib.packetOut.emit.name) {
+            ::error(ErrorType::ERR_UNSUPPORTED_ON_TARGET, "%1%: not supported in deparser", s);
+            return false;
+        }
+        auto expr = mcs->methodCall->arguments->at(0)->expression;
+        auto ht = program->typeMap->getType(expr, true)->to<IR::Type_Header>();
+        if (ht == nullptr) {
+            ::error(ErrorType::ERR_UNSUPPORTED_ON_TARGET,
+                    "Cannot emit a non-header type %1%", expr);
+            return false;
+        }
+        EmittedHeader h;
+        h.expr = expr;
+        h.type = ht;
+        h.path = headerPath(expr, headers, program->refMap, program->typeMap);
+        emitted.push_back(h);
+    }
+
+    analyzeControl();
+    analyzeLayout();
+    return ::errorCount() == 0;
+}
+
+void EBPFDeparser::analyzeControl() {
+    HeaderWrites controlWrites(this, program->control->headers);
+    program->control->controlBlock->container->apply(controlWrites);
+    // Header fields may also be assigned by the parser after extraction.
+    HeaderWrites parserWrites(this, program->parser->headers);
+    program->parser->parserBlock->container->apply(parserWrites);
+
+    std::map<cstring, unsigned> emitCount;
+    for (auto& h : emitted)
+        if (!h.path.isNullOrEmpty())
+            emitCount[h.path]++;
+
+    for (auto& h : emitted) {
+        if (allHeadersWritten || h.path.isNullOrEmpty() || emitCount[h.path] > 1 ||
+            validityChanged.count(h.path) != 0)
+            continue;
+        h.layoutStable = true;
+        auto fit = fieldsWritten.find(h.path);
+        if (fit == fieldsWritten.end())
+            h.contentStable = true;
+        else
+            h.writtenFields = fit->second;
+    }
+}
+
+void EBPFDeparser::analyzeLayout() {
+    // Order in which headers may be extracted: a header in before[h] may
+    // be extracted before h on some path through the parser.  Headers
+    // which are not tracked are recorded with an empty path.
+    struct Extract { cstring state; size_t index; cstring path; };
+    std::vector<Extract> extracts;
+    std::map<cstring, std::set<cstring>> successors;
+
+    auto parser = program->parser;
+    auto& p4lib = P4::P4CoreLibrary::instance;
+    for (auto state : parser->parserBlock->container->states) {
+        cstring name = state->name.name;
+        size_t index = 0;
+        for (auto c : state->components) {
+            auto mcs = c->to<IR::MethodCallStatement>();
+            if (mcs == nullptr)
+                continue;
+            auto mi = P4::MethodInstance::resolve(mcs->methodCall,
+                                                  program->refMap, program->typeMap);
+            auto em = mi->to<P4::ExternMethod>();
+            if (em == nullptr || em->object != parser->packet ||
+                em->method->name.name != p4lib.packetIn.extract.name)
+                continue;
+            auto dest = mcs->methodCall->arguments->at(0)->expression;
+            extracts.push_back({name, index++,
+                                headerPath(dest, parser->headers,
+                                           program->refMap, program->typeMap)});
+        }
+        auto select = state->selectExpression;
+        if (select == nullptr)
+            continue;
+        if (auto pe = select->to<IR::PathExpression>()) {
+            successors[name].emplace(pe->path->name.name);
+        } else if (auto se = select->to<IR::SelectExpression>()) {
+            for (auto sc : se->selectCases)
+                successors[name].emplace(sc->state->path->name.name);
+        }
+    }
+
+    // States reachable through at least one transition.
+    std::map<cstring, std::set<cstring>> reachable;
+    for (auto state : parser->parserBlock->container->states) {
+        auto& reach = reachable[state->name.name];
+        std::vector<cstring> work(successors[state->name.name].begin(),
+                                  successors[state->name.name].end());
+        while (!work.empty()) {
+            cstring s = work.back();
+            work.pop_back();
+            if (!reach.emplace(s).second)
+                continue;
+            for (auto n : successors[s])
+                work.push_back(n);
+        }
+    }
+
+    std::map<cstring, std::set<cstring>> before;
+    for (auto& a : extracts) {
+        for (auto& b : extracts) {
+            if ((a.state == b.state && a.index < b.index) ||
+                reachable[a.state].count(b.state) != 0)
+                before[b.path].emplace(a.path);
+        }
+    }
+    auto mayPrecede = [&before](cstring a, cstring b) { return before[b].count(a) != 0; };
+
+    // Headers before emitted[i] in the output are exactly the headers
+    // before it in the parsed packet, in the same order.
+    std::set<cstring> prefix;
+    for (size_t i = 0; i < emitted.size(); i++) {
+        auto& h = emitted[i];
+        if (!h.layoutStable)
+            break;
+        bool same = !mayPrecede(h.path, h.path);
+        for (auto x : before[h.path])
+            same = same && prefix.count(x) != 0;
+        for (size_t j = 0; j < i; j++)
+            same = same && !mayPrecede(h.path, emitted[j].path);
+        h.samePrefix = same;
+        prefix.emplace(h.path);
+    }
+
+    // Headers after emitted[i] in the output are exactly the headers
+    // after it in the parsed packet, in the same order.
+    std::set<cstring> suffix;
+    for (size_t i = emitted.size(); i-- > 0; ) {
+        auto& h = emitted[i];
+        if (!h.layoutStable)
+            break;
+        bool same = !mayPrecede(h.path, h.path);
+        for (auto& b : before) {
+            if (b.second.count(h.path) != 0)
+                same = same && suffix.count(b.first) != 0;
+        }
+        for (size_t j = i + 1; j < emitted.size(); j++)
+            same = same && !mayPrecede(emitted[j].path, h.path);
+        h.sameSuffix = same;
+        suffix.emplace(h.path);
+    }
+
+    for (auto& h : emitted)
+        LOG2("Deparser emits " << h.expr << (h.sameSuffix ? " at the same payload offset" :
+                                             h.samePrefix ? " at the same packet offset" : "") <<
+             (h.contentStable ? ", unchanged" : ""));
+}
+
+void EBPFDeparser::emitField(CodeBuilder* builder, const EmittedHeader& h,
+                             const IR::StructField* field, unsigned bitOffset) {
+    auto etype = EBPFTypeFactory::instance->create(program->typeMap->getType(field, true));
+    unsigned width = dynamic_cast<IHasWidth*>(etype)->widthInBits();
+    unsigned alignment = bitOffset % 8;
+    unsigned firstByte = bitOffset / 8;
+
+    if (width > 64) {
+        // Wide fields are stored as byte arrays in network order.
+        if (alignment != 0 || width % 8 != 0) {
+            ::error(ErrorType::ERR_UNSUPPORTED_ON_TARGET,
+                    "%1%: unaligned fields wider than 64 bits cannot be emitted", field);
+            return;
+        }
+        for (unsigned i = 0; i < width / 8; i++) {
+            builder->emitIndent();
+            builder->appendFormat("write_byte(%s, BYTES(%s) + %d, ",
+                                  program->packetStartVar.c_str(),
+                                  program->offsetVar.c_str(), firstByte + i);
+            codeGen->visit(h.expr);
+            builder->appendFormat(".%s[%d])", field->name.name.c_str(), i);
+            builder->endOfStatement(true);
+        }
+        return;
+    }
+
+    // The field occupies bits [alignment, alignment + width) of a window
+    // of 'bytes' bytes, numbering bits from the most significant one.
+    unsigned bytes = (alignment + width + 7) / 8;
+    int padding = 8 * bytes - alignment - width;
+    for (unsigned i = 0; i < bytes; i++) {
+        unsigned mask = 0;
+        for (unsigned bit = 0; bit < 8; bit++) {
+            unsigned pos = 8 * i + bit;
+            if (pos >= alignment && pos < alignment + width)
+                mask |= 0x80 >> bit;
+        }
+        int shift = 8 * (bytes - 1 - i) - padding;
+
+        builder->emitIndent();
+        if (mask == 0xFF)
+            builder->appendFormat("write_byte(%s, BYTES(%s) + %d, ",
+                                  program->packetStartVar.c_str(),
+                                  program->offsetVar.c_str(), firstByte + i);
+        else
+            builder->appendFormat("write_masked(%s, BYTES(%s) + %d, 0x%02x, ",
+                                  program->packetStartVar.c_str(),
+                                  program->offsetVar.c_str(), firstByte + i, mask);
+        builder->append("(u8)((u64)(");
+        codeGen->visit(h.expr);
+        builder->appendFormat(".%s)", field->name.name.c_str());
+        if (shift > 0)
+            builder->appendFormat(" >> %d", shift);
+        else if (shift < 0)
+            builder->appendFormat(" << %d", -shift);
+        builder->append("))");
+        builder->endOfStatement(true);
+    }
+}
+
+void EBPFDeparser::emitFields(CodeBuilder* builder, const EmittedHeader& h, bool all) {
+    unsigned bitOffset = 0;
+    for (auto f : h.type->fields) {
+        auto etype = EBPFTypeFactory::instance->create(program->typeMap->getType(f, true));
+        auto et = dynamic_cast<IHasWidth*>(etype);
+        if (et == nullptr) {
+            ::error(ErrorType::ERR_UNSUPPORTED_ON_TARGET,
+                    "Only headers with fixed widths supported %1%", f);
+            return;
+        }
+        if (all || h.writtenFields.count(f->name.name) != 0)
+            emitField(builder, h, f, bitOffset);
+        bitOffset += et->widthInBits();
+    }
+}
+
+void EBPFDeparser::emitHeader(CodeBuilder* builder, const EmittedHeader& h) {
+    unsigned width = h.type->width_bits();
+    builder->emitIndent();
+    builder->append("if (");
+    codeGen->visit(h.expr);
+    builder->append(".ebpf_valid) ");
+    builder->blockStart();
+
+    if (!h.sameSuffix || !h.contentStable) {
+        builder->emitIndent();
+        builder->appendFormat("if (%s < %s + BYTES(%s + %d)) ",
+                              program->packetEndVar.c_str(),
+                              program->packetStartVar.c_str(),
+                              program->offsetVar.c_str(), width);
+        builder->blockStart();
+        builder->emitIndent();
+        builder->appendFormat("return %s;", builder->target->abortReturnCode().c_str());
+        builder->newline();
+        builder->blockEnd(true);
+
+        if (h.sameSuffix) {
+            emitFields(builder, h, false);
+        } else if (h.samePrefix) {
+            builder->emitIndent();
+            builder->appendFormat("if (%s != 0) ", headerAdjustVar.c_str());
+            builder->blockStart();
+            emitFields(builder, h, true);
+            if (h.contentStable) {
+                builder->blockEnd(true);
+            } else {
+                builder->blockEnd(false);
+                builder->append(" else ");
+                builder->blockStart();
+                emitFields(builder, h, false);
+                builder->blockEnd(true);
+            }
+        } else {
+            emitFields(builder, h, true);
+        }
+    }
+
+    builder->emitIndent();
+    builder->appendFormat("%s += %d", program->offsetVar.c_str(), width);
+    builder->endOfStatement(true);
+    builder->blockEnd(true);
+}
+
+void EBPFDeparser::emit(CodeBuilder* builder) {
+    codeGen->setBuilder(builder);
+
+    builder->emitIndent();
+    builder->appendFormat("int %s = 0", outHeaderLengthVar.c_str());
+    builder->endOfStatement(true);
+    for (auto& h : emitted) {
+        builder->emitIndent();
+        builder->append("if (");
+        codeGen->visit(h.expr);
+        builder->appendFormat(".ebpf_valid) %s += %d",
+                              outHeaderLengthVar.c_str(), h.type->width_bits());
+        builder->endOfStatement(true);
+    }
+
+    // Move the packet start only if the headers changed length.
+    builder->emitIndent();
+    builder->appendFormat("int %s = BYTES(%s) - BYTES(%s)", headerAdjustVar.c_str(),
+                          program->offsetVar.c_str(), outHeaderLengthVar.c_str());
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->appendFormat("if (%s != 0) ", headerAdjustVar.c_str());
+    builder->blockStart();
+    cstring ctx = program->model.CPacketName.str();
+    cstring adjust = builder->target->adjustHead(ctx, headerAdjustVar);
+    builder->emitIndent();
+    if (adjust.isNullOrEmpty()) {
+        builder->appendLine("/* target cannot change the packet length */");
+        builder->emitIndent();
+        builder->appendFormat("return %s;", builder->target->abortReturnCode().c_str());
+        builder->newline();
+    } else {
+        builder->appendFormat("if (%s != 0) return %s;",
+                              adjust.c_str(), builder->target->abortReturnCode().c_str());
+        builder->newline();
+        builder->emitIndent();
+        builder->appendFormat("%s = %s", program->packetStartVar.c_str(),
+                              builder->target->dataOffset(ctx).c_str());
+        builder->endOfStatement(true);
+        builder->emitIndent();
+        builder->appendFormat("%s = %s", program->packetEndVar.c_str(),
+                              builder->target->dataEnd(ctx).c_str());
+        builder->endOfStatement(true);
+    }
+    builder->blockEnd(true);
+
+    builder->emitIndent();
+    builder->appendFormat("%s = 0", program->offsetVar.c_str());
+    builder->endOfStatement(true);
+    for (auto& h : emitted)
+        emitHeader(builder, h);
+}
+
+}  // namespace EBPF
@@ -0,0 +1,89 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _BACKENDS_EBPF_EBPFDEPARSER_H_
+#define _BACKENDS_EBPF_EBPFDEPARSER_H_
+
+#include "ir/ir.h"
+#include "ebpfObject.h"
+#include "ebpfProgram.h"
+
+namespace EBPF {
+
+class EBPFDeparser;
+
+/// One header emitted by the deparser, and what is known statically
+/// about where it lands in the output relative to the parsed packet.
+struct EmittedHeader {
+    const IR::Expression*  expr;
+    const IR::Type_Header* type;
+    /// Header path relative to the headers parameter, e.g. "ipv4";
+    /// empty for headers that cannot be tracked (such as stack elements).
+    cstring                path;
+    /// Validity is not changed by the control, so the header is present
+    /// in the output exactly when it was extracted.
+    bool                   layoutStable = false;
+    /// No field of the header is written by the control.
+    bool                   contentStable = false;
+    /// Fields written by the control; meaningful only if layoutStable.
+    std::set<cstring>      writtenFields;
+    /// Same byte offset from the packet start as when it was parsed,
+    /// provided the length of the headers does not change.
+    bool                   samePrefix = false;
+    /// Same byte offset from the payload as when it was parsed.
+    bool                   sameSuffix = false;
+};
+
+/// Emits the deparser as a rewrite of the packet in place: the packet
+/// start is only moved when the length of the emitted headers differs
+/// from the length of the parsed headers, and headers whose bytes are
+/// already in the right place are not written, or only the fields that
+/// the control has modified are written.
+class EBPFDeparser : public EBPFObject {
+    void analyzeControl();
+    void analyzeLayout();
+    void emitField(CodeBuilder* builder, const EmittedHeader& h,
+                   const IR::StructField* field, unsigned bitOffset);
+    void emitFields(CodeBuilder* builder, const EmittedHeader& h, bool all);
+    void emitHeader(CodeBuilder* builder, const EmittedHeader& h);
+
+ public:
+    const EBPFProgram*      program;
+    const IR::ControlBlock* controlBlock;
+    const IR::Parameter*    packet_out;
+    const IR::Parameter*    headers;
+    const IR::Parameter*    parserHeaders;
+    CodeGenInspector*       codeGen;
+    cstring                 outHeaderLengthVar;
+    cstring                 headerAdjustVar;
+
+    std::vector<EmittedHeader> emitted;
+    /// Header paths whose validity may be changed by the control.
+    std::set<cstring>       validityChanged;
+    /// Fields written by the control, by header path.
+    std::map<cstring, std::set<cstring>> fieldsWritten;
+    /// The control writes the headers in a way that cannot be tracked.
+    bool                    allHeadersWritten;
+
+    EBPFDeparser(const EBPFProgram* program, const IR::ControlBlock* block,
+                 const IR::Parameter* parserHeaders);
+    bool build();
+    void emit(CodeBuilder* builder);
+};
+
+}  // namespace EBPF
+
+#endif /* _BACKENDS_EBPF_EBPFDEPARSER_H_ */
@@ -23,4 +23,8 @@ EbpfOptions::EbpfOptions() {
         registerOption("--emit-externs", nullptr,
                 [this](const char*) { emitExterns = true; return true; },
                 "[ebpf back-end] Allow for user-provided implementation of extern functions.");
+        registerOption("--emit-percpu-counters", nullptr,
+                [this](const char*) { perCpuCounters = true; return true; },
+                "[ebpf back-end] Store counters in per-CPU maps and update them without\n"
+                "atomic operations; the control plane must sum the values of all CPUs.");
 }
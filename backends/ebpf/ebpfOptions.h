@@ -29,6 +29,8 @@ class EbpfOptions : public CompilerOptions {
     bool loadIRFromJson = false;
     // Externs generation
     bool emitExterns = false;
+    // Store counters in per-CPU maps
+    bool perCpuCounters = false;
     EbpfOptions();
 };
 
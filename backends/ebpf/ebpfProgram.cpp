@@ -20,6 +20,7 @@ limitations under the License.
 #include "ebpfProgram.h"
 #include "ebpfType.h"
 #include "ebpfControl.h"
+#include "ebpfDeparser.h"
 #include "ebpfParser.h"
 #include "ebpfTable.h"
 #include "frontends/p4/coreLibrary.h"
@@ -29,13 +30,15 @@ namespace EBPF {
 
 bool EBPFProgram::build() {
     auto pack = toplevel->getMain();
-    if (pack->type->name != "ebpfFilter")
+    if (pack->type->name != "ebpfFilter" && pack->type->name != "ebpfRewriteFilter")
         ::warning(ErrorType::WARN_INVALID, "%1%: the main ebpf package should be called ebpfFilter"
-                  "; are you using the wrong architecture?", pack->type->name);
+                  " or ebpfRewriteFilter; are you using the wrong architecture?",
+                  pack->type->name);
 
-    if (pack->getConstructorParameters()->size() != 2) {
+    size_t paramCount = pack->getConstructorParameters()->size();
+    if (paramCount != 2 && paramCount != 3) {
         ::error(ErrorType::ERR_EXPECTED,
-                "Expected toplevel package %1% to have 2 parameters", pack->type);
+                "Expected toplevel package %1% to have 2 or 3 parameters", pack->type);
         return false;
     }
 
@@ -55,6 +58,16 @@ bool EBPFProgram::build() {
     if (!success)
         return success;
 
+    if (paramCount == 3) {
+        auto db = pack->getParameterValue(model.filter.deparser.name)
+                          ->to<IR::ControlBlock>();
+        BUG_CHECK(db != nullptr, "No deparser block found");
+        deparser = new EBPFDeparser(this, db, parser->headers);
+        success = deparser->build();
+        if (!success)
+            return success;
+    }
+
     return true;
 }
 
@@ -99,6 +112,13 @@ void EBPFProgram::emitC(CodeBuilder* builder, cstring header) {
 
     builder->emitIndent();
     builder->appendFormat("%s:\n", endLabel.c_str());
+    if (deparser != nullptr) {
+        builder->emitIndent();
+        builder->appendFormat("if (%s) ", control->accept->name.name.c_str());
+        builder->blockStart();
+        deparser->emit(builder);
+        builder->blockEnd(true);
+    }
     builder->emitIndent();
     builder->appendFormat("if (%s)\n", control->accept->name.name.c_str());
     builder->increaseIndent();
@@ -201,6 +221,10 @@ void EBPFProgram::emitPreamble(CodeBuilder* builder) {
     builder->appendLine("#define write_byte(base, offset, v) do { "
                         "*(u8*)((base) + (offset)) = (v); "
                         "} while (0)");
+    builder->appendLine("#define write_masked(base, offset, m, v) do { "
+                        "u8* __wm_p = (u8*)((base) + (offset)); "
+                        "*__wm_p = (*__wm_p & ~(m)) | ((v) & (m)); "
+                        "} while (0)");
     builder->newline();
     builder->appendLine("void* memcpy(void* dest, const void* src, size_t num);");
     builder->newline();
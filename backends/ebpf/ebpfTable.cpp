@@ -75,6 +75,10 @@ EBPFTable::EBPFTable(const EBPFProgram* program, const IR::TableBlock* table,
 
     keyGenerator = table->container->getKey();
     actionList = table->container->getActionList();
+
+    auto dap = table->container->properties->getProperty(
+        IR::TableProperties::defaultActionPropertyName);
+    constDefaultAction = dap != nullptr && dap->isConstant;
 }
 
 void EBPFTable::emitKeyType(CodeBuilder* builder) {
@@ -283,6 +287,8 @@ void EBPFTable::emitInstance(CodeBuilder* builder) {
                                        cstring("struct ") + keyTypeName,
                                        cstring("struct ") + valueTypeName, size);
     }
+    if (constDefaultAction)
+        return;
     builder->target->emitTableDecl(builder, defaultActionMapName, TableArray,
                                    program->arrayIndexType,
                                    cstring("struct ") + valueTypeName, 1);
@@ -348,10 +354,8 @@ void EBPFTable::emitAction(CodeBuilder* builder, cstring valueName) {
     builder->blockEnd(true);
 }
 
-void EBPFTable::emitInitializer(CodeBuilder* builder) {
-    // emit code to initialize the default action
-    const IR::P4Table* t = table->container;
-    const IR::Expression* defaultAction = t->getDefaultAction();
+void EBPFTable::emitDefaultActionValue(CodeBuilder* builder, cstring valueName) {
+    const IR::Expression* defaultAction = table->container->getDefaultAction();
     BUG_CHECK(defaultAction->is<IR::MethodCallExpression>(),
               "%1%: expected an action call", defaultAction);
     auto mce = defaultAction->to<IR::MethodCallExpression>();
@@ -361,24 +365,9 @@ void EBPFTable::emitInitializer(CodeBuilder* builder) {
     BUG_CHECK(ac != nullptr, "%1%: expected an action call", mce);
     auto action = ac->action;
     cstring name = EBPFObject::externalName(action);
-    cstring fd = "tableFileDescriptor";
-    cstring defaultTable = defaultActionMapName;
-    cstring value = "value";
-    cstring key = "key";
 
     builder->emitIndent();
-    builder->blockStart();
-    builder->emitIndent();
-    builder->appendFormat("int %s = BPF_OBJ_GET(MAP_PATH \"/%s\")",
-                          fd.c_str(), defaultTable.c_str());
-    builder->endOfStatement(true);
-    builder->emitIndent();
-    builder->appendFormat("if (%s < 0) { fprintf(stderr, \"map %s not loaded\\n\"); exit(1); }",
-                          fd.c_str(), defaultTable.c_str());
-    builder->newline();
-
-    builder->emitIndent();
-    builder->appendFormat("struct %s %s = ", valueTypeName.c_str(), value.c_str());
+    builder->appendFormat("struct %s %s = ", valueTypeName.c_str(), valueName.c_str());
     builder->blockStart();
     builder->emitIndent();
     builder->appendFormat(".action = %s,", name.c_str());
@@ -398,24 +387,54 @@ void EBPFTable::emitInitializer(CodeBuilder* builder) {
 
     builder->blockEnd(false);
     builder->endOfStatement(true);
+}
 
-    builder->emitIndent();
-    builder->append("int ok = ");
-    builder->target->emitUserTableUpdate(builder, fd, program->zeroKey, value);
-    builder->newline();
+void EBPFTable::emitInitializer(CodeBuilder* builder) {
+    const IR::P4Table* t = table->container;
+    const IR::Expression* defaultAction = t->getDefaultAction();
+    cstring fd = "tableFileDescriptor";
+    cstring defaultTable = defaultActionMapName;
+    cstring value = "value";
+    cstring key = "key";
 
-    builder->emitIndent();
-    builder->appendFormat("if (ok != 0) { "
-                          "perror(\"Could not write in %s\"); exit(1); }",
-                          defaultTable.c_str());
-    builder->newline();
-    builder->blockEnd(true);
+    // emit code to initialize the default action; a const default
+    // action is compiled into the data plane and has no map.
+    if (!constDefaultAction) {
+        builder->emitIndent();
+        builder->blockStart();
+        builder->emitIndent();
+        builder->appendFormat("int %s = BPF_OBJ_GET(MAP_PATH \"/%s\")",
+                              fd.c_str(), defaultTable.c_str());
+        builder->endOfStatement(true);
+        builder->emitIndent();
+        builder->appendFormat("if (%s < 0) { "
+                              "fprintf(stderr, \"map %s not loaded\\n\"); exit(1); }",
+                              fd.c_str(), defaultTable.c_str());
+        builder->newline();
+
+        emitDefaultActionValue(builder, value);
+
+        builder->emitIndent();
+        builder->append("int ok = ");
+        builder->target->emitUserTableUpdate(builder, fd, program->zeroKey, value);
+        builder->newline();
+
+        builder->emitIndent();
+        builder->appendFormat("if (ok != 0) { "
+                              "perror(\"Could not write in %s\"); exit(1); }",
+                              defaultTable.c_str());
+        builder->newline();
+        builder->blockEnd(true);
+    }
 
     // Emit code for table initializer
     auto entries = t->getEntries();
     if (entries == nullptr)
         return;
 
+    CodeGenInspector cg(program->refMap, program->typeMap);
+    cg.setBuilder(builder);
+
     builder->emitIndent();
     builder->blockStart();
     builder->emitIndent();
@@ -490,7 +509,7 @@ void EBPFTable::emitInitializer(CodeBuilder* builder) {
 
 EBPFCounterTable::EBPFCounterTable(const EBPFProgram* program, const IR::ExternBlock* block,
                                    cstring name, CodeGenInspector* codeGen) :
-        EBPFTableBase(program, name, codeGen) {
+        EBPFTableBase(program, name, codeGen), perCpu(program->options.perCpuCounters) {
     auto sz = block->getParameterValue(program->model.counterArray.max_index.name);
     if (sz == nullptr || !sz->is<IR::Constant>()) {
         ::error(ErrorType::ERR_INVALID,
@@ -521,11 +540,33 @@ EBPFCounterTable::EBPFCounterTable(const EBPFProgram* program, const IR::ExternB
 }
 
 void EBPFCounterTable::emitInstance(CodeBuilder* builder) {
-    TableKind kind = isHash ? TableHash : TableArray;
+    TableKind kind;
+    if (perCpu)
+        kind = isHash ? TablePerCPUHash : TablePerCPUArray;
+    else
+        kind = isHash ? TableHash : TableArray;
     builder->target->emitTableDecl(
         builder, dataMapName, kind, keyTypeName, valueTypeName, size);
 }
 
+/// Emits the update of an existing counter value.  Per-CPU counters are only
+/// ever written by the current CPU, so they do not need an atomic operation.
+void EBPFCounterTable::emitCounterUpdate(CodeBuilder* builder, cstring valueName,
+                                         cstring increment) {
+    builder->emitIndent();
+    builder->appendFormat("if (%s != NULL)", valueName.c_str());
+    builder->newline();
+    builder->increaseIndent();
+    builder->emitIndent();
+    if (perCpu)
+        builder->appendFormat("*%s += %s;", valueName.c_str(), increment.c_str());
+    else
+        builder->appendFormat("__sync_fetch_and_add(%s, %s);",
+                              valueName.c_str(), increment.c_str());
+    builder->newline();
+    builder->decreaseIndent();
+}
+
 void EBPFCounterTable::emitCounterIncrement(CodeBuilder* builder,
                                             const IR::MethodCallExpression *expression) {
     cstring keyName = program->refMap->newName("key");
@@ -559,14 +600,7 @@ void EBPFCounterTable::emitCounterIncrement(CodeBuilder* builder,
     builder->target->emitTableLookup(builder, dataMapName, keyName, valueName);
     builder->endOfStatement(true);
 
-    builder->emitIndent();
-    builder->appendFormat("if (%s != NULL)", valueName.c_str());
-    builder->newline();
-    builder->increaseIndent();
-    builder->emitIndent();
-    builder->appendFormat("__sync_fetch_and_add(%s, 1);", valueName.c_str());
-    builder->newline();
-    builder->decreaseIndent();
+    emitCounterUpdate(builder, valueName, "1");
 
     builder->emitIndent();
     builder->appendLine("else");
@@ -622,14 +656,7 @@ void EBPFCounterTable::emitCounterAdd(CodeBuilder* builder,
     builder->target->emitTableLookup(builder, dataMapName, keyName, valueName);
     builder->endOfStatement(true);
 
-    builder->emitIndent();
-    builder->appendFormat("if (%s != NULL)", valueName.c_str());
-    builder->newline();
-    builder->increaseIndent();
-    builder->emitIndent();
-    builder->appendFormat("__sync_fetch_and_add(%s, %s);", valueName.c_str(), incName.c_str());
-    builder->newline();
-    builder->decreaseIndent();
+    emitCounterUpdate(builder, valueName, incName);
 
     builder->emitIndent();
     builder->appendLine("else");
@@ -51,6 +51,9 @@ class EBPFTable final : public EBPFTableBase {
     const IR::TableBlock*    table;
     cstring               defaultActionMapName;
     cstring               actionEnumName;
+    // True if the default action is declared const; it is then compiled
+    // into the miss branch instead of being stored in defaultActionMapName.
+    bool                  constDefaultAction;
     std::map<const IR::KeyElement*, cstring> keyFieldNames;
     std::map<const IR::KeyElement*, EBPFType*> keyTypes;
 
@@ -62,12 +65,15 @@ class EBPFTable final : public EBPFTableBase {
     void emitValueType(CodeBuilder* builder);
     void emitKey(CodeBuilder* builder, cstring keyName);
     void emitAction(CodeBuilder* builder, cstring valueName);
+    void emitDefaultActionValue(CodeBuilder* builder, cstring valueName);
     void emitInitializer(CodeBuilder* builder);
 };
 
 class EBPFCounterTable final : public EBPFTableBase {
     size_t    size;
     bool      isHash;
+    bool      perCpu;
+    void emitCounterUpdate(CodeBuilder* builder, cstring valueName, cstring increment);
  public:
     EBPFCounterTable(const EBPFProgram* program, const IR::ExternBlock* block,
                      cstring name, CodeGenInspector* codeGen);
@@ -48,9 +48,47 @@ limitations under the License.
 #ifdef CONTROL_PLANE // BEGIN EBPF USER SPACE DEFINITIONS
 
 #include "bpf.h" // bpf_obj_get/pin, bpf_map_update_elem
+#include "libbpf.h" // libbpf_num_possible_cpus
+#include <string.h> // memcpy
 
 #define BPF_USER_MAP_UPDATE_ELEM(index, key, value, flags)\
     bpf_map_update_elem(index, key, value, flags)
+#define BPF_USER_COUNTER_READ(index, key, sum)\
+    bpf_counter_read(index, key, sum)
+
+/* A lookup in a per-CPU map from user space returns one value for each
+ * possible CPU; counters are the sum of these values. The kernel rounds
+ * the size of each value up to 8 bytes, so the 32-bit counter of a CPU is
+ * found at the start of its 8-byte slot. Other counter maps hold a single
+ * 32-bit value. */
+static inline int bpf_counter_read(int fd, const void *key, __u64 *sum) {
+    struct bpf_map_info info = {};
+    __u32 info_len = sizeof(info);
+    int ret = bpf_obj_get_info_by_fd(fd, &info, &info_len);
+    if (ret != 0)
+        return ret;
+    if (info.type != BPF_MAP_TYPE_PERCPU_HASH && info.type != BPF_MAP_TYPE_PERCPU_ARRAY) {
+        __u32 value;
+        ret = bpf_map_lookup_elem(fd, key, &value);
+        if (ret == 0)
+            *sum = value;
+        return ret;
+    }
+    int cpus = libbpf_num_possible_cpus();
+    if (cpus <= 0)
+        return -1;
+    __u64 values[cpus];
+    ret = bpf_map_lookup_elem(fd, key, values);
+    if (ret != 0)
+        return ret;
+    *sum = 0;
+    for (int i = 0; i < cpus; i++) {
+        __u32 value;
+        memcpy(&value, &values[i], sizeof(value));
+        *sum += value;
+    }
+    return 0;
+}
 #define BPF_OBJ_PIN(table, name) bpf_obj_pin(table, name)
 #define BPF_OBJ_GET(name) bpf_obj_get(name)
 
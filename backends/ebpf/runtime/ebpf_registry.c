@@ -168,6 +168,14 @@ void *registry_lookup_table_elem_id(int tbl_id, void *key) {
     return bpf_map_lookup_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
 }
 
+int registry_read_counter_id(int tbl_id, void *key, unsigned long long *sum) {
+    unsigned int *value = registry_lookup_table_elem_id(tbl_id, key);
+    if (value == NULL)
+        return EXIT_FAILURE;
+    *sum = *value;
+    return EXIT_SUCCESS;
+}
+
 int registry_get_id(const char *name) {
     registry_entry *tmp_reg = find_register(name);
     if (tmp_reg == NULL)
@@ -159,4 +159,15 @@ void *registry_lookup_table_elem(const char *name, void *key);
  */
 void *registry_lookup_table_elem_id(int tbl_id, void *key);
 
+/**
+ * @brief Read a counter, which may be stored in a per-CPU map.
+ * @details The kernel keeps one u32 value per CPU for each key of a per-CPU
+ * counter map and the control plane has to aggregate them. The user space
+ * registry emulates a single CPU, so the counter is the value of the entry
+ * whatever the map type.
+ * This operation uses an integer as the key.
+ * @return EXIT_FAILURE if the table or the key cannot be found.
+ */
+int registry_read_counter_id(int tbl_id, void *key, unsigned long long *sum);
+
 #endif  // BACKENDS_EBPF_RUNTIME_EBPF_REGISTRY_H_
@@ -143,6 +143,12 @@ int main(int argc, char **argv) {
 #endif
 
     launch_runtime(pcap_name, num_pcaps);
+    int result = EXIT_SUCCESS;
+#ifdef CONTROL_PLANE
+    /* Compare the counters with the values expected by the control file */
+    if (check_counters() != 0)
+        result = EXIT_FAILURE;
+#endif
     DELETE_EBPF_TABLES(debug);
-    return EXIT_SUCCESS;
+    return result;
 }
@@ -22,6 +22,8 @@ limitations under the License.
 #include "ebpf_runtime_test.h"
 
 #define PCAPOUT "_out.pcap"
+/* Space in front of each packet, as reserved by XDP drivers */
+#define XDP_PACKET_HEADROOM 256
 
 /**
  * @brief Feed a list packets into an eBPF program.
@@ -39,8 +41,33 @@ pcap_list_t *feed_packets(packet_filter ebpf_filter, pcap_list_t *pkt_list, int
     uint32_t list_len = get_pkt_list_length(pkt_list);
     for (uint32_t i = 0; i < list_len; i++) {
         /* Parse each packet in the list and check the result */
-        struct sk_buff skb;
         pcap_pkt *input_pkt = get_packet(pkt_list, i);
+#ifdef EBPF_XDP
+        /* The program may move the packet start, so leave room in front */
+        uint32_t len = input_pkt->pcap_hdr.len;
+        char *buffer = malloc(XDP_PACKET_HEADROOM + len);
+        memcpy(buffer + XDP_PACKET_HEADROOM, input_pkt->data, len);
+        struct xdp_md ctx;
+        ctx.data_hard_start = buffer;
+        ctx.data = buffer + XDP_PACKET_HEADROOM;
+        ctx.data_end = buffer + XDP_PACKET_HEADROOM + len;
+        ctx.ingress_ifindex = input_pkt->ifindex;
+        int result = ebpf_filter(&ctx);
+        /* XDP_TX sends the packet back out of the interface it came from,
+         * which is where XDP_PASS packets are recorded as well. */
+        if (result == XDP_PASS || result == XDP_TX) {
+            pcap_pkt *out_pkt = copy_pkt(input_pkt);
+            uint32_t out_len = (char *) ctx.data_end - (char *) ctx.data;
+            free(out_pkt->data);
+            out_pkt->data = malloc(out_len);
+            memcpy(out_pkt->data, ctx.data, out_len);
+            out_pkt->pcap_hdr.len = out_len;
+            out_pkt->pcap_hdr.caplen = out_len;
+            output_pkts = append_packet(output_pkts, out_pkt);
+        }
+        free(buffer);
+#else
+        struct sk_buff skb;
         skb.data = (void *) input_pkt->data;
         skb.len = input_pkt->pcap_hdr.len;
         int result = ebpf_filter(&skb);
@@ -49,6 +76,7 @@ pcap_list_t *feed_packets(packet_filter ebpf_filter, pcap_list_t *pkt_list, int
             pcap_pkt *out_pkt = copy_pkt(input_pkt);
             output_pkts = append_packet(output_pkts, out_pkt);
         }
+#endif
         if (debug)
             printf("Result of the eBPF parsing is: %d\n", result);
     }
@@ -26,7 +26,11 @@ limitations under the License.
 #include "pcap_util.h"
 #include "ebpf_test.h"
 
+#ifdef EBPF_XDP
+typedef int (*packet_filter)(struct xdp_md* s);
+#else
 typedef int (*packet_filter)(SK_BUFF* s);
+#endif
 
 void *run_and_record_output(packet_filter ebpf_filter, const char *pcap_base, pcap_list_t *pkt_list, int debug);
 void init_ebpf_tables(int debug);
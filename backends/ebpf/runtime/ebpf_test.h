@@ -69,6 +69,33 @@ struct sk_buff {
     u32 ifindex;
 };
 
+/* simple descriptor which replaces the kernel xdp_md structure;
+ * data_hard_start is the start of the headroom in front of the packet */
+struct xdp_md {
+    void *data;
+    void *data_end;
+    void *data_hard_start;
+    u32 ingress_ifindex;
+};
+
+/* XDP program return codes, copied from "linux/bpf" */
+enum xdp_action {
+    XDP_ABORTED = 0,
+    XDP_DROP,
+    XDP_PASS,
+    XDP_TX,
+    XDP_REDIRECT,
+};
+
+/* moves the start of the packet, mimics the kernel helper */
+static inline int bpf_xdp_adjust_head(struct xdp_md *ctx, int delta) {
+    u8 *data = (u8 *)ctx->data + delta;
+    if (data < (u8 *)ctx->data_hard_start || data > (u8 *)ctx->data_end)
+        return -1;
+    ctx->data = data;
+    return 0;
+}
+
 /* flags for BPF_MAP_UPDATE_ELEM command, copied from "linux/bpf" */
 #define BPF_ANY     0 /* create new element or update existing */
 #define BPF_NOEXIST 1 /* create new element if it didn't exist */
@@ -100,13 +127,19 @@ struct bpf_table tables[] = {
     registry_delete_table_elem(MAP_PATH"/"#table, key)
 #define BPF_USER_MAP_UPDATE_ELEM(index, key, value, flags)\
     registry_update_table_id(index, key, value, flags)
+#define BPF_USER_COUNTER_READ(index, key, sum)\
+    registry_read_counter_id(index, key, sum)
 #define BPF_OBJ_PIN(table, name) registry_add(table)
 #define BPF_OBJ_GET(name) registry_get_id(name)
 
 
 /* These should be automatically generated and included in the generated x.h header file */
 extern struct bpf_table tables[];
+#ifdef EBPF_XDP
+extern int ebpf_filter(struct xdp_md *skb);
+#else
 extern int ebpf_filter(struct sk_buff *skb);
+#endif
 
 
 #endif  // BACKENDS_EBPF_RUNTIME_EBPF_USER_H_
@@ -15,20 +15,22 @@ P4FILE=
 P4C=p4c-ebpf
 # the default target is test but it can be overridden
 TARGET=test
+# The runtime to link against; targets sharing a runtime override this
+RUNTIME=$(TARGET)
 # Extra arguments for the compiler
 P4ARGS=
 
 # Argument for the GCC compiler
 GCC ?= gcc
 BUILDDIR:= $(BPFDIR)build
-override INCLUDES+= -I$(ROOT_DIR) -include $(ROOT_DIR)ebpf_runtime_$(TARGET).h
+override INCLUDES+= -I$(ROOT_DIR) -include $(ROOT_DIR)ebpf_runtime_$(RUNTIME).h
 # Optimization flags to save space
 override CFLAGS+= -O2 -g # -Wall -Werror
 override LIBS+= -lpcap
 
 # The base files required to build the runtime
 SOURCE_BASE= $(ROOT_DIR)ebpf_runtime.c $(ROOT_DIR)pcap_util.c
-SOURCE_BASE+= $(ROOT_DIR)ebpf_runtime_$(TARGET).c
+SOURCE_BASE+= $(ROOT_DIR)ebpf_runtime_$(RUNTIME).c
 # Add the generated file and externs to the base sources
 override SOURCES+= $(SOURCE_BASE)
 SRC_PROCESSED= $(notdir $(SOURCES))
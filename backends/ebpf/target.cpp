@@ -54,6 +54,10 @@ void KernelSamplesTarget::emitTableDecl(Util::SourceCodeBuilder* builder,
         kind = "BPF_MAP_TYPE_ARRAY";
     else if (tableKind == TableLPMTrie)
         kind = "BPF_MAP_TYPE_LPM_TRIE";
+    else if (tableKind == TablePerCPUHash)
+        kind = "BPF_MAP_TYPE_PERCPU_HASH";
+    else if (tableKind == TablePerCPUArray)
+        kind = "BPF_MAP_TYPE_PERCPU_ARRAY";
     else
         BUG("%1%: unsupported table kind", tableKind);
     builder->appendFormat("REGISTER_TABLE(%s, %s, ", tblName.c_str(), kind.c_str());
@@ -82,6 +86,19 @@ void KernelSamplesTarget::emitMain(Util::SourceCodeBuilder* builder,
 
 //////////////////////////////////////////////////////////////
 
+void XdpTarget::emitCodeSection(Util::SourceCodeBuilder* builder, cstring) const {
+    builder->append("SEC(\"xdp\")\n");
+}
+
+void XdpTarget::emitMain(Util::SourceCodeBuilder* builder,
+                         cstring functionName,
+                         cstring argName) const {
+    builder->appendFormat("int %s(struct xdp_md *%s)",
+                          functionName.c_str(), argName.c_str());
+}
+
+//////////////////////////////////////////////////////////////
+
 void TestTarget::emitIncludes(Util::SourceCodeBuilder* builder) const {
     builder->append("#include \"ebpf_test.h\"\n");
     builder->newline();
@@ -99,6 +116,15 @@ void TestTarget::emitTableDecl(Util::SourceCodeBuilder* builder,
 
 //////////////////////////////////////////////////////////////
 
+void XdpTestTarget::emitMain(Util::SourceCodeBuilder* builder,
+                             cstring functionName,
+                             cstring argName) const {
+    builder->appendFormat("int %s(struct xdp_md *%s)",
+                          functionName.c_str(), argName.c_str());
+}
+
+//////////////////////////////////////////////////////////////
+
 void BccTarget::emitTableLookup(Util::SourceCodeBuilder* builder, cstring tblName,
                                 cstring key, cstring value) const {
     builder->appendFormat("%s = %s.lookup(&%s)",
@@ -136,6 +162,10 @@ void BccTarget::emitTableDecl(Util::SourceCodeBuilder* builder,
         kind = "array";
     else if (tableKind == TableLPMTrie)
         kind = "lpm_trie";
+    else if (tableKind == TablePerCPUHash)
+        kind = "percpu_hash";
+    else if (tableKind == TablePerCPUArray)
+        kind = "percpu_array";
     else
         BUG("%1%: unsupported table kind", tableKind);
 
@@ -29,7 +29,14 @@ namespace EBPF {
 enum TableKind {
     TableHash,
     TableArray,
-    TableLPMTrie  // longest prefix match trie
+    TableLPMTrie,  // longest prefix match trie
+    // Maps holding a separate value for each CPU; lookups return the value
+    // of the current CPU, so updates need no atomic operations.
+    TablePerCPUHash,
+    TablePerCPUArray,
+    // Ternary and range matches resolved by priority; only the uBPF target
+    // provides such a map.
+    TableClassifier
 };
 
 class Target {
@@ -61,6 +68,13 @@ class Target {
     virtual cstring forwardReturnCode() const = 0;
     virtual cstring dropReturnCode() const = 0;
     virtual cstring abortReturnCode() const = 0;
+    // Expression moving the packet start forward by delta bytes (a negative
+    // delta grows the packet), which evaluates to 0 on success; null if the
+    // target cannot change the packet length.
+    virtual cstring adjustHead(cstring, cstring) const { return nullptr; }
+    // True if dataOffset() points to the packet bytes, which may then be
+    // written in place.
+    virtual bool directPacketAccess() const { return true; }
     // Path on /sys filesystem where maps are stored
     virtual cstring sysMapPath() const = 0;
 };
@@ -114,20 +128,39 @@ class BccTarget : public Target {
     void emitMain(Util::SourceCodeBuilder* builder,
                   cstring functionName,
                   cstring argName) const override;
+    // The packet is only read through load_byte() and friends on the skb.
     cstring dataOffset(cstring base) const override { return base; }
     cstring dataEnd(cstring base) const override
     { return cstring("(") + base + " + " + base + "->len)"; }
+    bool directPacketAccess() const override { return false; }
     cstring forwardReturnCode() const override { return "0"; }
     cstring dropReturnCode() const override { return "1"; }
     cstring abortReturnCode() const override { return "1"; }
     cstring sysMapPath() const override { return "/sys/fs/bpf"; }
 };
 
+// Represents a target that attaches to the XDP hook of a network driver;
+// packets are processed before an sk_buff is allocated for them.
+class XdpTarget : public KernelSamplesTarget {
+ public:
+    XdpTarget() : KernelSamplesTarget("XDP") {}
+    void emitCodeSection(Util::SourceCodeBuilder* builder, cstring sectionName) const override;
+    void emitMain(Util::SourceCodeBuilder* builder,
+                  cstring functionName,
+                  cstring argName) const override;
+    cstring forwardReturnCode() const override { return "XDP_PASS"; }
+    cstring dropReturnCode() const override { return "XDP_DROP"; }
+    cstring abortReturnCode() const override { return "XDP_ABORTED"; }
+    cstring adjustHead(cstring base, cstring delta) const override
+    { return cstring("bpf_xdp_adjust_head(") + base + ", " + delta + ")"; }
+    cstring sysMapPath() const override { return "/sys/fs/bpf/xdp/globals"; }
+};
+
 // A userspace test version with functionality equivalent to the kernel
 // Compiles with gcc
 class TestTarget : public EBPF::KernelSamplesTarget {
  public:
-    TestTarget() : KernelSamplesTarget("Userspace Test") {}
+    explicit TestTarget(cstring name = "Userspace Test") : KernelSamplesTarget(name) {}
     void emitIncludes(Util::SourceCodeBuilder* builder) const override;
     void emitTableDecl(Util::SourceCodeBuilder* builder,
                        cstring tblName, TableKind tableKind,
@@ -142,6 +175,23 @@ class TestTarget : public EBPF::KernelSamplesTarget {
     cstring sysMapPath() const override { return "/sys/fs/bpf"; }
 };
 
+// The userspace test version of the XDP target; the runtime is built
+// with EBPF_XDP so that it passes an xdp_md to the program.
+class XdpTestTarget : public TestTarget {
+ public:
+    XdpTestTarget() : TestTarget("Userspace XDP Test") {}
+    void emitMain(Util::SourceCodeBuilder* builder,
+                  cstring functionName,
+                  cstring argName) const override;
+    cstring dataEnd(cstring base) const override
+    { return cstring("((void*)(long)")+ base + "->data_end)"; }
+    cstring forwardReturnCode() const override { return "XDP_PASS"; }
+    cstring dropReturnCode() const override { return "XDP_DROP"; }
+    cstring abortReturnCode() const override { return "XDP_ABORTED"; }
+    cstring adjustHead(cstring base, cstring delta) const override
+    { return cstring("bpf_xdp_adjust_head(") + base + ", " + delta + ")"; }
+};
+
 }  // namespace EBPF
 
 #endif /* _BACKENDS_EBPF_TARGET_H_ */
@@ -24,6 +24,16 @@ from testutils import *
 from stf.stf_parser import STFParser
 
 
+class eBPFCounterCheck(object):
+    """ Defines the expected value of an eBPF counter"""
+
+    def __init__(self, counter, index, cond, value):
+        self.counter = counter      # name of the counter map
+        self.index = index          # index of the checked counter
+        self.cond = cond            # C comparison operator
+        self.value = value          # value to compare with
+
+
 class eBPFCommand(object):
     """ Defines a match-action command for eBPF programs"""
 
@@ -76,7 +86,36 @@ def _generate_control_actions(cmds):
     return generated
 
 
-def create_table_file(actions, tmpdir, file_name):
+def _generate_counter_checks(checks):
+    """ Generates the counter checks.
+    This function inserts C code for all the "check_counter" commands that
+    have been parsed. eBPF counters hold a single value, which is compared
+    regardless of the counted type. Counters are read with
+    BPF_USER_COUNTER_READ, which sums the values of all CPUs when the
+    program was compiled with --emit-percpu-counters. """
+    generated = ""
+    for index, check in enumerate(checks):
+        key_name = "key_%s%d" % (check.counter, index)
+        generated += "u32 %s = %s;\n\t" % (key_name, check.index)
+        generated += ("tableFileDescriptor = "
+                      "BPF_OBJ_GET(MAP_PATH \"/%s\");\n\t" %
+                      check.counter)
+        generated += ("if (tableFileDescriptor < 0) {"
+                      "fprintf(stderr, \"map %s not loaded\");"
+                      " exit(1); }\n\t" % check.counter)
+        # counters which were never updated are not in hash maps
+        generated += ("if (BPF_USER_COUNTER_READ"
+                      "(tableFileDescriptor, &%s, &value) != 0) "
+                      "value = 0;\n\t" % key_name)
+        generated += ("if (!(value %s %s)) {"
+                      "fprintf(stderr, \"%s(%s) is %%llu, expected %s %s\\n\", "
+                      "value); failed = 1; }\n\t"
+                      % (check.cond, check.value, check.counter, check.index,
+                         check.cond, check.value))
+    return generated
+
+
+def create_table_file(actions, tmpdir, file_name, checks=[]):
     """ Create the control plane file.
     The control commands are provided by the stf parser.
     This generated file is required by ebpf_runtime.c to initialize
@@ -91,6 +130,14 @@ def create_table_file(actions, tmpdir, file_name):
             control_file.write("int tableFileDescriptor;\n\t")
             generated_cmds = _generate_control_actions(actions)
             control_file.write(generated_cmds)
+            control_file.write("}\n\n")
+            control_file.write("static inline int check_counters() {")
+            control_file.write("\n\t")
+            control_file.write("int failed = 0;\n\t")
+            control_file.write("int tableFileDescriptor;\n\t")
+            control_file.write("unsigned long long value;\n\t")
+            control_file.write(_generate_counter_checks(checks))
+            control_file.write("return failed;\n")
             control_file.write("}\n")
     except OSError as e:
         err = e
@@ -106,6 +153,7 @@ def parse_stf_file(raw_stf):
     stf_map, errs = parser.parse(stf_str)
     input_pkts = {}
     cmds = []
+    checks = []
     expected = {}
     for stf_entry in stf_map:
         if stf_entry[0] == "packet":
@@ -130,4 +178,9 @@ def parse_stf_file(raw_stf):
             cmd = eBPFCommand(
                 a_type=stf_entry[0], table=stf_entry[1], action=stf_entry[2])
             cmds.append(cmd)
-    return input_pkts, cmds, expected
+        elif stf_entry[0] == "check_counter":
+            count_type, cond, value = stf_entry[3]
+            checks.append(eBPFCounterCheck(
+                counter=stf_entry[1], index=stf_entry[2],
+                cond=cond, value=value))
+    return input_pkts, cmds, checks, expected
@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+# Copyright 2013-present Barefoot Networks, Inc.
+# Copyright 2018 VMware, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from .test_target import Target as TestTarget
+
+
+class Target(TestTarget):
+    """ Runs programs generated for the XDP hook in the user-space test
+        runtime. The runtime is shared with the test target and built with
+        EBPF_XDP, which makes it pass an xdp_md to the program and
+        interpret XDP return codes. """
+
+    def get_make_args(self, runtimedir, target):
+        args = TestTarget.get_make_args(self, runtimedir, target)
+        args += "RUNTIME=test "
+        args += "CFLAGS+=-DEBPF_XDP "
+        return args
@@ -23,6 +23,9 @@ sys.path.insert(0, os.path.dirname(
 run_ebpf_test = importlib.import_module('run-ebpf-test')
 
 arg_parser = run_ebpf_test.PARSER
+arg_parser.add_argument("--benchmark", dest="bench", type=int, default=0,
+                        help="replay the input packets this many times and "
+                        "report the packet rate of the filter")
 
 if __name__ == "__main__":
     # Parse options and process argv
@@ -37,6 +40,7 @@ if __name__ == "__main__":
     # Switch test directory based on path to run-ubpf-test.py
     options.testdir = os.path.dirname(os.path.realpath(__file__))
     options.extern = args.extern
+    options.bench = args.bench
 
     # All args after '--' are intended for the p4 compiler
     argv = argv[1:]
@@ -27,6 +27,7 @@ limitations under the License.
 #define DELIM   '_'
 
 static int debug = 0;
+static int iterations = 0;
 
 void usage(char *name) {
     fprintf(stderr, "This program expects a pcap file pattern, "
@@ -34,8 +35,9 @@ void usage(char *name) {
             "in the order given by the packet time,"
             "then feeds the individual packets into a filter function, "
             "and returns the output.\n");
-    fprintf(stderr, "Usage: %s [-d] -f file.pcap -n num_pcaps\n", name);
+    fprintf(stderr, "Usage: %s [-d] [-b iterations] -f file.pcap -n num_pcaps\n", name);
     fprintf(stderr, "Options:\n");
+    fprintf(stderr, "\t-b: Replay the input packets this many times and report the rate\n");
     fprintf(stderr, "\t-d: Turn on debug messages\n");
     fprintf(stderr, "\t-f: The input pcap file\n");
     fprintf(stderr, "\t-n: Specifies the number of input pcap files\n");
@@ -78,6 +80,9 @@ void launch_runtime(const char *pcap_name, uint16_t num_pcaps) {
     input_list = get_packets(pcap_base, num_pcaps, input_list);
     /* Sort the list */
     sort_pcap_list(input_list);
+    /* Measure the throughput on a copy of the packets and tables */
+    if (iterations > 0)
+        BENCHMARK(entry, input_list, iterations);
     /* Run the "program" and retrieve output lists */
     RUN(entry, pcap_base, num_pcaps, input_list, debug);
     /* Delete the list of input packets */
@@ -90,11 +95,18 @@ int main(int argc, char **argv) {
     int c;
     opterr = 0;
 
-    while ((c = getopt (argc, argv, "dn:f:")) != -1) {
+    while ((c = getopt (argc, argv, "db:n:f:")) != -1) {
         switch (c) {
             case 'd':
             debug = 1;
             break;
+            case 'b':
+                iterations = (int)strtol(optarg, (char **)NULL, 10);
+                if (iterations < 0) {
+                    fprintf(stderr, "Number of iterations cannot be negative\n");
+                    return EXIT_FAILURE;
+                }
+            break;
             case 'n':
                 num_pcaps = (int)strtol(optarg, (char **)NULL, 10);
                 if (num_pcaps < 0 || num_pcaps > UINT16_MAX) {
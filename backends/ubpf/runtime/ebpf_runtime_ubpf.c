@@ -15,23 +15,27 @@ limitations under the License.
 */
 
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "ebpf_runtime_ubpf.h"
 
 
 #define PCAPOUT "_out.pcap"
 
+struct std_meta {
+    uint32_t input_port;
+    uint32_t packet_length;
+    uint32_t output_action;
+    uint32_t output_port;
+};
+
 pcap_list_t *feed_packets(packet_filter ebpf_filter, pcap_list_t *pkt_list, int debug) {
     pcap_list_t *output_pkts = allocate_pkt_list();
     uint32_t list_len = get_pkt_list_length(pkt_list);
     for (uint32_t i = 0; i < list_len; i++) {
         /* Parse each packet in the list and check the result */
         struct dp_packet dp;
-        struct std_meta {
-            uint32_t input_port;
-            uint32_t packet_length;
-            uint32_t output_action;
-            uint32_t output_port;
-        };
         struct std_meta md;
         pcap_pkt *input_pkt = get_packet(pkt_list, i);
         dp.data = (void *) input_pkt->data;
@@ -80,4 +84,52 @@ void *run_and_record_output(packet_filter entry, const char *pcap_base, pcap_lis
     write_pkts_to_pcaps(pcap_base, output_array, debug);
     /* Delete the array, including the data it is holding */
     delete_array(output_array);
-}
\ No newline at end of file
+}
+
+void benchmark_packets(packet_filter entry, pcap_list_t *pkt_list, int iterations) {
+    /* The program updates its tables, counters and registers, so the benchmark
+     * runs in a child process, on a copy of them, and the recorded run starts
+     * from the state the control plane set up */
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("Could not start the benchmark");
+        return;
+    }
+    if (pid > 0) {
+        waitpid(pid, NULL, 0);
+        return;
+    }
+    uint32_t list_len = get_pkt_list_length(pkt_list);
+    void *buffer = NULL;
+    uint32_t capacity = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int it = 0; it < iterations; it++) {
+        for (uint32_t i = 0; i < list_len; i++) {
+            /* The program may modify the packet, so it runs on a copy */
+            pcap_pkt *pkt = get_packet(pkt_list, i);
+            uint32_t len = pkt->pcap_hdr.len;
+            if (capacity < len) {
+                buffer = realloc(buffer, len);
+                capacity = len;
+            }
+            memcpy(buffer, pkt->data, len);
+            struct dp_packet dp = { .data = buffer, .size_ = len };
+            struct std_meta md = { .input_port = pkt->ifindex, .packet_length = len };
+            entry(&dp, (struct standard_metadata *) &md);
+            /* Resizing the packet reallocates it to its new size */
+            buffer = dp.data;
+            if (dp.size_ != len)
+                capacity = dp.size_;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free(buffer);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    uint64_t total = (uint64_t) iterations * list_len;
+    printf("Benchmark: %llu packets in %.6f s, %.3f Mpps\n", (unsigned long long) total,
+           seconds, seconds > 0 ? total / seconds / 1e6 : 0.0);
+    fflush(stdout);
+    _exit(EXIT_SUCCESS);
+}
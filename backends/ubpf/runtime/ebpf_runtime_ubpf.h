@@ -20,6 +20,7 @@ limitations under the License.
 #include <stdint.h>
 #include "../../ebpf/runtime/pcap_util.h"
 #include "../../ebpf/runtime/ebpf_registry.h"
+#include "ubpf_classifier.h"
 #include "ubpf_test.h"
 
 struct standard_metadata;
@@ -28,6 +29,7 @@ extern uint64_t entry(void *, struct standard_metadata *);
 typedef uint64_t (*packet_filter)(void *dp, struct standard_metadata *std_meta);
 
 void *run_and_record_output(packet_filter entry, const char *pcap_base, pcap_list_t *pkt_list, int debug);
+void benchmark_packets(packet_filter entry, pcap_list_t *pkt_list, int iterations);
 
 static void inline init_ubpf_table_test(char *name, unsigned int key_size, unsigned int value_size) {
     struct bpf_table tbl = {
@@ -40,6 +42,15 @@ static void inline init_ubpf_table_test(char *name, unsigned int key_size, unsig
     registry_add(&tbl);
 }
 
+/* Adds an entry to a classifier if the table has one, to its hash map otherwise */
+static inline int ubpf_table_add_test(const char *name, void *key, void *mask,
+                                      uint32_t priority, void *value) {
+    struct ubpf_classifier *cls = ubpf_classifier_find(name);
+    if (cls != NULL)
+        return ubpf_classifier_add(cls, key, mask, NULL, 0, priority, value);
+    return registry_update_table(name, key, value, 0);
+}
+
 
 #define ubpf_printf(fmt, args) \
     ubpf_printf_test(fmt, args)
@@ -53,11 +64,19 @@ static void inline init_ubpf_table_test(char *name, unsigned int key_size, unsig
     registry_lookup_table_elem(#table, key)
 #define ubpf_map_update(table, key, value) \
     registry_update_table(#table, key, value, 0)
+#define ubpf_classifier_lookup(table, key) \
+    ubpf_classifier_lookup_test(#table, key)
 
 #define INIT_UBPF_TABLE(name, key_size, value_size) init_ubpf_table_test("&"name, key_size, value_size)
+#define INIT_UBPF_CLASSIFIER(name, key_size, value_size) \
+    ubpf_classifier_create("&"name, key_size, value_size)
+#define UBPF_TABLE_ADD(table, key, mask, priority, value) \
+    ubpf_table_add_test(#table, key, mask, priority, value)
 
 #define RUN(entry, pcap_base, num_pcaps, input_list, debug) \
     run_and_record_output(entry, pcap_base, input_list, debug)
+#define BENCHMARK(entry, input_list, iterations) \
+    benchmark_packets(entry, input_list, iterations)
 #define INIT_EBPF_TABLES(debug)
 #define DELETE_EBPF_TABLES(debug)
 
@@ -29,6 +29,7 @@ override CFLAGS+=-O2 -g # -Wall -Werror
 LIBS+=-lpcap
 SOURCES=$(EBPFDIR)/ebpf_registry.c  $(EBPFDIR)/ebpf_map.c $(BPFNAME).c $(EXTERNOBJ)
 SRC_BASE+=$(SRCDIR)/ebpf_runtime.c $(EBPFDIR)/pcap_util.c $(SOURCES)
+SRC_BASE+=$(SRCDIR)/ubpf_classifier.c
 SRC_BASE+=$(SRCDIR)/ebpf_runtime_$(TARGET).c
 OBJECTS = $(SRC_BASE:%.c=$(BUILDDIR)/%.o)
 DEPS = $(OBJECTS:.o=.d)
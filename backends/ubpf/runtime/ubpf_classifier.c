@@ -0,0 +1,232 @@
+/*
+Copyright 2020 Orange
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include "../../ebpf/runtime/contrib/uthash.h"  // exports string.h, stddef.h, and stdlib.h
+#include "ubpf_classifier.h"
+
+struct cls_entry {
+    uint32_t priority;
+    uint64_t seq;               // insertion order, breaks ties between priorities
+    struct cls_entry *next;
+    uint8_t value[];
+};
+
+/* All the entries of a tuple sharing a masked key, best first. */
+struct cls_rule {
+    struct cls_entry *entries;
+    UT_hash_handle hh;
+    uint8_t key[];
+};
+
+/* All the entries sharing a mask. */
+struct cls_tuple {
+    uint8_t *mask;
+    uint32_t max_priority;      // highest priority of the entries of the tuple
+    struct cls_rule *rules;
+    struct cls_tuple *next;
+};
+
+struct ubpf_classifier {
+    char *name;
+    unsigned int key_size;
+    unsigned int value_size;
+    uint64_t next_seq;
+    struct cls_tuple *tuples;   // sorted by decreasing max_priority
+    UT_hash_handle hh;
+};
+
+static struct ubpf_classifier *classifiers = NULL;
+
+static int better(const struct cls_entry *a, const struct cls_entry *b) {
+    return a->priority > b->priority || (a->priority == b->priority && a->seq < b->seq);
+}
+
+static void *allocate(size_t size) {
+    void *ptr = calloc(1, size);
+    if (!ptr) {
+        perror("Fatal: Could not allocate memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+int ubpf_classifier_create(const char *name, unsigned int key_size, unsigned int value_size) {
+    if (ubpf_classifier_find(name) != NULL) {
+        fprintf(stderr, "Error: Classifier %s already exists!\n", name);
+        return EXIT_FAILURE;
+    }
+    struct ubpf_classifier *cls = allocate(sizeof(struct ubpf_classifier));
+    cls->name = strdup(name);
+    cls->key_size = key_size;
+    cls->value_size = value_size;
+    HASH_ADD_KEYPTR(hh, classifiers, cls->name, strlen(cls->name), cls);
+    return EXIT_SUCCESS;
+}
+
+struct ubpf_classifier *ubpf_classifier_find(const char *name) {
+    struct ubpf_classifier *cls;
+    HASH_FIND(hh, classifiers, name, strlen(name), cls);
+    return cls;
+}
+
+/* Moves a tuple whose max_priority was raised to its place in the list. */
+static void sort_tuple(struct ubpf_classifier *cls, struct cls_tuple *tuple) {
+    struct cls_tuple **pos = &cls->tuples;
+    while (*pos != tuple)
+        pos = &(*pos)->next;
+    *pos = tuple->next;
+    pos = &cls->tuples;
+    while (*pos != NULL && (*pos)->max_priority >= tuple->max_priority)
+        pos = &(*pos)->next;
+    tuple->next = *pos;
+    *pos = tuple;
+}
+
+static struct cls_tuple *get_tuple(struct ubpf_classifier *cls, const uint8_t *mask,
+                                   uint32_t priority) {
+    struct cls_tuple *tuple;
+    for (tuple = cls->tuples; tuple != NULL; tuple = tuple->next) {
+        if (memcmp(tuple->mask, mask, cls->key_size) == 0)
+            break;
+    }
+    if (tuple == NULL) {
+        tuple = allocate(sizeof(struct cls_tuple));
+        tuple->mask = allocate(cls->key_size);
+        memcpy(tuple->mask, mask, cls->key_size);
+        tuple->max_priority = priority;
+        tuple->next = cls->tuples;
+        cls->tuples = tuple;
+        sort_tuple(cls, tuple);
+    } else if (priority > tuple->max_priority) {
+        tuple->max_priority = priority;
+        sort_tuple(cls, tuple);
+    }
+    return tuple;
+}
+
+static void insert_entry(struct ubpf_classifier *cls, const uint8_t *key, const uint8_t *mask,
+                         uint32_t priority, const void *value) {
+    struct cls_tuple *tuple = get_tuple(cls, mask, priority);
+    uint8_t masked[cls->key_size];
+    for (unsigned int i = 0; i < cls->key_size; i++)
+        masked[i] = key[i] & mask[i];
+
+    struct cls_rule *rule;
+    HASH_FIND(hh, tuple->rules, masked, cls->key_size, rule);
+    if (rule == NULL) {
+        rule = allocate(sizeof(struct cls_rule) + cls->key_size);
+        memcpy(rule->key, masked, cls->key_size);
+        HASH_ADD_KEYPTR(hh, tuple->rules, rule->key, cls->key_size, rule);
+    }
+
+    struct cls_entry **pos = &rule->entries;
+    while (*pos != NULL && (*pos)->priority >= priority)
+        pos = &(*pos)->next;
+    struct cls_entry *entry = allocate(sizeof(struct cls_entry) + cls->value_size);
+    entry->priority = priority;
+    entry->seq = cls->next_seq++;
+    memcpy(entry->value, value, cls->value_size);
+    entry->next = *pos;
+    *pos = entry;
+}
+
+static void write_field(uint8_t *field, unsigned int size, uint64_t v) {
+    uint8_t v8 = v;
+    uint16_t v16 = v;
+    uint32_t v32 = v;
+    switch (size) {
+        case 1: memcpy(field, &v8, size); break;
+        case 2: memcpy(field, &v16, size); break;
+        case 4: memcpy(field, &v32, size); break;
+        default: memcpy(field, &v, size); break;
+    }
+}
+
+/*
+ * Splits the range of field i into aligned blocks of 2^k values, each of which
+ * is a single value under a prefix mask, and recurses on the next field.
+ */
+static void expand_ranges(struct ubpf_classifier *cls, uint8_t *key, uint8_t *mask,
+                          const struct ubpf_classifier_range *ranges, unsigned int n_ranges,
+                          unsigned int i, uint32_t priority, const void *value) {
+    if (i == n_ranges) {
+        insert_entry(cls, key, mask, priority, value);
+        return;
+    }
+    const struct ubpf_classifier_range *r = &ranges[i];
+    unsigned int bits = 8 * r->size;
+    uint64_t full = bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+    uint64_t lo = r->low;
+    for (;;) {
+        /* Grow the block while lo stays aligned on it and it ends before high */
+        unsigned int k = 0;
+        while (k < bits && (lo & ((2ULL << k) - 1)) == 0 && ((2ULL << k) - 1) <= r->high - lo)
+            k++;
+        uint64_t span = k == 64 ? ~0ULL : (1ULL << k) - 1;
+        write_field(key + r->offset, r->size, lo);
+        write_field(mask + r->offset, r->size, full & ~span);
+        expand_ranges(cls, key, mask, ranges, n_ranges, i + 1, priority, value);
+        if (r->high - lo <= span)
+            break;
+        lo += span + 1;
+    }
+}
+
+int ubpf_classifier_add(struct ubpf_classifier *cls, const void *key, const void *mask,
+                        const struct ubpf_classifier_range *ranges, unsigned int n_ranges,
+                        uint32_t priority, const void *value) {
+    for (unsigned int i = 0; i < n_ranges; i++) {
+        const struct ubpf_classifier_range *r = &ranges[i];
+        int valid_size = r->size == 1 || r->size == 2 || r->size == 4 || r->size == 8;
+        if (!valid_size || r->offset + r->size > cls->key_size || r->low > r->high ||
+            (r->size < 8 && r->high >> (8 * r->size) != 0)) {
+            fprintf(stderr, "Error: Invalid range for classifier %s\n", cls->name);
+            return EXIT_FAILURE;
+        }
+    }
+    uint8_t key_copy[cls->key_size];
+    uint8_t mask_copy[cls->key_size];
+    memcpy(key_copy, key, cls->key_size);
+    memcpy(mask_copy, mask, cls->key_size);
+    expand_ranges(cls, key_copy, mask_copy, ranges, n_ranges, 0, priority, value);
+    return EXIT_SUCCESS;
+}
+
+void *ubpf_classifier_lookup_elem(const struct ubpf_classifier *cls, const void *key) {
+    const uint8_t *k = key;
+    uint8_t masked[cls->key_size];
+    struct cls_entry *best = NULL;
+    for (struct cls_tuple *tuple = cls->tuples; tuple != NULL; tuple = tuple->next) {
+        /* Tuples are sorted, so none of the remaining ones can do better */
+        if (best != NULL && tuple->max_priority < best->priority)
+            break;
+        for (unsigned int i = 0; i < cls->key_size; i++)
+            masked[i] = k[i] & tuple->mask[i];
+        struct cls_rule *rule;
+        HASH_FIND(hh, tuple->rules, masked, cls->key_size, rule);
+        if (rule != NULL && (best == NULL || better(rule->entries, best)))
+            best = rule->entries;
+    }
+    return best == NULL ? NULL : best->value;
+}
+
+void *ubpf_classifier_lookup_test(const char *name, const void *key) {
+    struct ubpf_classifier *cls = ubpf_classifier_find(name);
+    if (cls == NULL)
+        return NULL;
+    return ubpf_classifier_lookup_elem(cls, key);
+}
@@ -0,0 +1,83 @@
+/*
+Copyright 2020 Orange
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+ * This file defines the classifier backing tables with ternary and range keys.
+ * Entries are grouped by mask into tuples, and each tuple hashes the masked
+ * keys of its entries (tuple space search). A lookup probes the tuples in
+ * decreasing order of their highest priority and stops as soon as no remaining
+ * tuple can hold a better entry. Ranges are expanded into masked entries when
+ * they are inserted. This library is currently not thread-safe.
+ */
+
+#ifndef P4C_UBPF_CLASSIFIER_H
+#define P4C_UBPF_CLASSIFIER_H
+
+#include <stdint.h>
+
+/**
+ * @brief A range of values [low, high] for one key field.
+ * @details The field is an unsigned integer of 1, 2, 4 or 8 bytes in host
+ * byte order, as the generated code stores key fields.
+ */
+struct ubpf_classifier_range {
+    unsigned int offset;    // offset of the field in the key structure
+    unsigned int size;      // size of the field in bytes
+    uint64_t low;
+    uint64_t high;
+};
+
+struct ubpf_classifier;
+
+/**
+ * @brief Creates an empty classifier.
+ * @details Classifiers are identified by name, like the tables of the registry.
+ * @return EXIT_FAILURE if a classifier with that name already exists.
+ */
+int ubpf_classifier_create(const char *name, unsigned int key_size, unsigned int value_size);
+
+/**
+ * @brief Retrieves a classifier by name.
+ * @return NULL if the classifier cannot be found.
+ */
+struct ubpf_classifier *ubpf_classifier_find(const char *name);
+
+/**
+ * @brief Inserts an entry into the classifier.
+ * @details A key matches the entry if it equals "key" on all the bits set in
+ * "mask" and lies within each of the given ranges; the bits of ranged fields
+ * are ignored in "key" and "mask". When several entries match, the one with
+ * the highest priority wins, and the first inserted among equal priorities.
+ * @return EXIT_FAILURE if a range is malformed.
+ */
+int ubpf_classifier_add(struct ubpf_classifier *cls, const void *key, const void *mask,
+                        const struct ubpf_classifier_range *ranges, unsigned int n_ranges,
+                        uint32_t priority, const void *value);
+
+/**
+ * @brief Finds the value of the best entry matching a key.
+ * @return NULL if no entry matches.
+ */
+void *ubpf_classifier_lookup_elem(const struct ubpf_classifier *cls, const void *key);
+
+/**
+ * @brief Finds the value of the best entry matching a key.
+ * @details Same as ubpf_classifier_lookup_elem, for a classifier identified by name.
+ * @return NULL if the classifier cannot be found or no entry matches.
+ */
+void *ubpf_classifier_lookup_test(const char *name, const void *key);
+
+#endif  // P4C_UBPF_CLASSIFIER_H
@@ -43,6 +43,13 @@ namespace UBPF {
                               tblName.c_str(), key.c_str());
     }
 
+    void UbpfTarget::emitClassifierLookup(Util::SourceCodeBuilder *builder,
+                                          cstring tblName,
+                                          cstring key) const {
+        builder->appendFormat("ubpf_classifier_lookup(&%s, &%s)",
+                              tblName.c_str(), key.c_str());
+    }
+
     void UbpfTarget::emitTableUpdate(Util::SourceCodeBuilder *builder,
                                      cstring tblName,
                                      cstring key,
@@ -67,6 +74,8 @@ namespace UBPF {
             type = "UBPF_MAP_TYPE_ARRAY";
         } else if (tableKind == EBPF::TableLPMTrie) {
             type = "UBPF_MAP_TYPE_LPM_TRIE";
+        } else if (tableKind == EBPF::TableClassifier) {
+            type = "UBPF_MAP_TYPE_CLASSIFIER";
         } else {
             BUG("%1%: unsupported table kind", tableKind);
         }
@@ -119,6 +128,7 @@ namespace UBPF {
                 "static void *(*ubpf_packet_data)(const void *) = (void *)9;\n"
                 "static void *(*ubpf_adjust_head)(const void *, uint64_t) = (void *)8;\n"
                 "static uint32_t (*ubpf_truncate_packet)(const void *, uint64_t) = (void *)11;\n"
+                "static void *(*ubpf_classifier_lookup)(const void *, const void *) = (void *)12;\n"
                 "\n");
         builder->newline();
         builder->appendLine(
@@ -34,6 +34,8 @@ namespace UBPF {
         void emitIncludes(Util::SourceCodeBuilder *builder) const override;
         void emitTableLookup(Util::SourceCodeBuilder *builder, cstring tblName,
                              cstring key, cstring value) const override;
+        void emitClassifierLookup(Util::SourceCodeBuilder *builder, cstring tblName,
+                                  cstring key) const;
         void emitTableUpdate(Util::SourceCodeBuilder *builder, cstring tblName,
                              cstring key, cstring value) const override;
         void emitGetPacketData(Util::SourceCodeBuilder *builder,
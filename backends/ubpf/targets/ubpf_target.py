@@ -46,13 +46,49 @@ class Target(EBPFTarget):
         args += "-f " + pcap_pattern + " "
         # Number of input interfaces
         args += "-n " + str(num_files) + " "
+        # Throughput measurement
+        if self.options.bench > 0:
+            args += "-b " + str(self.options.bench) + " "
         # Debug flag (verbose output)
         args += "-d"
         errmsg = "Failed to execute the filter:"
         result = run_timeout(self.options.verbose, args,
                              TIMEOUT, self.outputs, errmsg)
+        if result == SUCCESS and self.options.bench > 0:
+            self._report_benchmark()
         return result
 
+    def _report_benchmark(self):
+        """ Prints the packet rate measured by the runtime. """
+        with open(self.outputs["stdout"]) as stdout:
+            for line in stdout:
+                if line.startswith("Benchmark:"):
+                    print("%s: %s" % (os.path.basename(self.options.p4filename),
+                                      line.strip()))
+
+    @staticmethod
+    def _match_to_c(key_name, mask_name, field, value):
+        """ Sets a key field and its mask. Ternary values use '*' for
+            the digits to ignore, lpm values are (value, prefix length)
+            pairs and anything else is matched exactly. The mask is only
+            used by classifier tables. """
+        if isinstance(value, tuple):
+            value, prefix = value[0], int(value[1], 0)
+            generated = "%s.%s = %s;\n\t" % (key_name, field, value)
+            if prefix > 0:
+                generated += ("%s.%s = ~0ULL << (8 * sizeof(%s.%s) - %d);\n\t"
+                              % (mask_name, field, mask_name, field, prefix))
+            return generated
+        if "*" in value:
+            prefix, digits = value[:2], value[2:]
+            ones = "F" if prefix in ("0x", "0X") else "1"
+            key = prefix + digits.replace("*", "0")
+            mask = prefix + "".join("0" if d == "*" else ones for d in digits)
+            return ("%s.%s = %s;\n\t%s.%s = %s;\n\t"
+                    % (key_name, field, key, mask_name, field, mask))
+        return ("%s.%s = %s;\n\tmemset(&%s.%s, 0xff, sizeof(%s.%s));\n\t"
+                % (key_name, field, value, mask_name, field, mask_name, field))
+
     def _generate_control_actions(self, cmds):
         generated = ""
 
@@ -63,13 +99,15 @@ class Target(EBPFTarget):
 
         for index, cmd in enumerate(cmds):
             key_name = "key_%s%d" % (cmd.table, index)
+            mask_name = "mask_%s%d" % (cmd.table, index)
             value_name = "value_%s%d" % (cmd.table, index)
             if cmd.a_type == "add":
                 generated += "struct %s_key %s = {};\n\t" % (cmd.table, key_name)
+                generated += "struct %s_key %s = {};\n\t" % (cmd.table, mask_name)
                 for key_num, key_field in enumerate(cmd.match):
                     field = key_field[0].split('.')[1]
-                    generated += ("%s.%s = %s;\n\t"
-                                  % (key_name, field, key_field[1]))
+                    generated += self._match_to_c(key_name, mask_name,
+                                                  field, key_field[1])
             generated += ("struct %s_value %s = {\n\t\t" % (
                 cmd.table, value_name))
             generated += ".action = %s,\n\t\t" % (cmd.action[0])
@@ -78,9 +116,10 @@ class Target(EBPFTarget):
                 generated += "%s," % val_field[1]
             generated += "}},\n\t"
             generated += "};\n\t"
-            generated += ("ubpf_map_update"
-                          "(&%s, &%s, &%s);\n\t"
-                          % (cmd.table, key_name, value_name))
+            priority = int(cmd.priority) if cmd.priority else 0
+            generated += ("UBPF_TABLE_ADD"
+                          "(&%s, &%s, &%s, %d, &%s);\n\t"
+                          % (cmd.table, key_name, mask_name, priority, value_name))
         return generated
 
     def create_ubpf_table_file(self, actions, tmpdir, file_name):
@@ -100,7 +139,7 @@ class Target(EBPFTarget):
 
     def generate_model_inputs(self, stffile):
         with open(stffile) as raw_stf:
-            input_pkts, cmds, self.expected = parse_stf_file(
+            input_pkts, cmds, _, self.expected = parse_stf_file(
                 raw_stf)
             result, err = self.create_ubpf_table_file(cmds, self.tmpdir, "control.h")
             if result != SUCCESS:
@@ -218,8 +218,7 @@ namespace UBPF {
             builder->appendLine("/* perform lookup */");
             builder->emitIndent();
             builder->appendFormat("%s = ", valueName.c_str());
-            builder->target->emitTableLookup(builder, table->dataMapName,
-                                             keyname, valueName);
+            table->emitLookup(builder, keyname, valueName);
             builder->endOfStatement(true);
         }
 
@@ -72,7 +72,8 @@ namespace UBPF {
                       csum_replace2("csum_replace2"),
                       csum_replace4("csum_replace4"),
                       hashAlgorithm(),
-                      hash() {}
+                      hash(),
+                      rangeMatch("range") {}
 
     public:
         static UBPFModel instance;
@@ -90,6 +91,7 @@ namespace UBPF {
         ::Model::Extern_Model csum_replace4;
         Algorithm_Model hashAlgorithm;
         Hash_Model hash;
+        ::Model::Elem rangeMatch;
         unsigned version = 20200515;
 
         static cstring reserved(cstring name) { return reservedPrefix + name; }
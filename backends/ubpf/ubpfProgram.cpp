@@ -195,6 +195,10 @@ namespace UBPF {
         builder->append("UBPF_MAP_TYPE_LPM_TRIE = 5,");
         builder->newline();
 
+        builder->emitIndent();
+        builder->append("UBPF_MAP_TYPE_CLASSIFIER = 6,");
+        builder->newline();
+
         builder->blockEnd(false);
         builder->endOfStatement(true);
 
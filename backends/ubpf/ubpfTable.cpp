@@ -202,19 +202,28 @@ void UBPFTable::setTableKind() {
     // set table kind to HASH by default
     EBPF::TableKind tableKind = EBPF::TableHash;
 
-    // If any key field is LPM we will generate an LPM table
+    // If any key field is LPM we will generate an LPM table,
+    // if any key field is ternary or range we will generate a classifier.
+    const IR::KeyElement *secondLpm = nullptr;
     for (auto it : keyGenerator->keyElements) {
         auto mtdecl = program->refMap->getDeclaration(it->matchType->path, true);
         auto matchType = mtdecl->getNode()->to<IR::Declaration_ID>();
         if (matchType->name.name == P4::P4CoreLibrary::instance.lpmMatch.name) {
-            if (tableKind == EBPF::TableLPMTrie) {
-                ::error(ErrorType::ERR_UNSUPPORTED,
-                        "only one LPM field allowed", it->matchType);
-                return;
-            }
-            tableKind = EBPF::TableLPMTrie;
+            if (tableKind == EBPF::TableLPMTrie && secondLpm == nullptr)
+                secondLpm = it;
+            if (tableKind == EBPF::TableHash)
+                tableKind = EBPF::TableLPMTrie;
+        } else if (matchType->name.name == P4::P4CoreLibrary::instance.ternaryMatch.name ||
+                   matchType->name.name == UBPFModel::instance.rangeMatch.name) {
+            tableKind = EBPF::TableClassifier;
         }
     }
+    // The classifier matches prefixes as masks, so it has no such limit.
+    if (tableKind == EBPF::TableLPMTrie && secondLpm != nullptr) {
+        ::error(ErrorType::ERR_UNSUPPORTED,
+                "only one LPM field allowed", secondLpm->matchType);
+        return;
+    }
     this->tableKind = tableKind;
 }
 
@@ -290,7 +299,9 @@ void UBPFTable::emitKeyType(EBPF::CodeBuilder *builder) {
                     c->matchType->path, true);
             auto matchType = mtdecl->getNode()->to<IR::Declaration_ID>();
             if (matchType->name.name != P4::P4CoreLibrary::instance.exactMatch.name &&
-                matchType->name.name != P4::P4CoreLibrary::instance.lpmMatch.name)
+                matchType->name.name != P4::P4CoreLibrary::instance.lpmMatch.name &&
+                matchType->name.name != P4::P4CoreLibrary::instance.ternaryMatch.name &&
+                matchType->name.name != UBPFModel::instance.rangeMatch.name)
                 ::error(ErrorType::ERR_UNSUPPORTED_ON_TARGET,
                         "Match of type %1% not supported", c->matchType);
             key_idx++;
@@ -415,6 +426,16 @@ void UBPFTable::emitKey(EBPF::CodeBuilder *builder, cstring keyName) {
     }
 }
 
+void UBPFTable::emitLookup(EBPF::CodeBuilder *builder, cstring keyName, cstring valueName) {
+    if (tableKind != EBPF::TableClassifier) {
+        builder->target->emitTableLookup(builder, dataMapName, keyName, valueName);
+        return;
+    }
+    auto target = dynamic_cast<const UbpfTarget *>(builder->target);
+    BUG_CHECK(target != nullptr, "%1%: classifier tables need the uBPF target", instanceName);
+    target->emitClassifierLookup(builder, dataMapName, keyName);
+}
+
 void UBPFTable::emitAction(EBPF::CodeBuilder *builder, cstring valueName) {
     builder->emitIndent();
     builder->appendFormat("switch (%s->action) ", valueName.c_str());
@@ -506,6 +527,16 @@ void UBPFTable::emitInitializer(EBPF::CodeBuilder *builder) {
     builder->endOfStatement(true);
     builder->blockEnd(true);
 
+    // Entries of a classifier are added by the control plane,
+    // the classifier itself has to exist before.
+    if (tableKind == EBPF::TableClassifier) {
+        builder->emitIndent();
+        builder->appendFormat("INIT_UBPF_CLASSIFIER(\"%s\", sizeof(struct %s), "
+                              "sizeof(struct %s));", dataMapName.c_str(),
+                              keyTypeName.c_str(), valueTypeName.c_str());
+        builder->newline();
+    }
+
 
     // Check if there are const entries.
     auto entries = t->getEntries();
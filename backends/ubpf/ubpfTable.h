@@ -78,6 +78,7 @@ namespace UBPF {
         void emitKeyType(EBPF::CodeBuilder *builder);
         void emitValueType(EBPF::CodeBuilder *builder);
         void emitKey(EBPF::CodeBuilder *builder, cstring keyName);
+        void emitLookup(EBPF::CodeBuilder *builder, cstring keyName, cstring valueName);
         void emitAction(EBPF::CodeBuilder *builder, cstring valueName);
         void emitInitializer(EBPF::CodeBuilder *builder);
     };
@@ -17,6 +17,7 @@ limitations under the License.
 #include <google/protobuf/text_format.h>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <google/protobuf/util/delimited_message_util.h>
 #include <google/protobuf/util/json_util.h>
 
 #include <algorithm>
@@ -137,6 +138,14 @@ static bool writeTo(const Message& message, std::ostream* destination) {
     return true;
 }
 
+/// Serialize the protobuf @message to @destination in the binary protocol
+/// buffers format, prefixed by its size encoded as a varint. Unlike writeTo(),
+/// the stream is not flushed so that many messages can be written in a row.
+static bool writeDelimitedTo(const Message& message, std::ostream* destination) {
+    CHECK_NULL(destination);
+    return google::protobuf::util::SerializeDelimitedToOstream(message, destination);
+}
+
 /// Serialize the protobuf @message to @destination in the JSON protocol buffers
 /// format. This is intended for debugging and testing.
 static bool writeJsonTo(const Message& message, std::ostream* destination) {
@@ -912,6 +921,10 @@ class P4RuntimeAnalyzer {
      * handles architecture-specific constructs (e.g. externs).
      * @param arch  The name of the P4_16 architecture the program was written
      * against.
+     * @param entriesStreams  If not empty, the static table entries are written
+     * to these streams as they are converted (see
+     * P4RuntimeSerializer::generateP4Runtime) instead of being accumulated in
+     * the returned WriteRequest.
      * @return a P4Info message representing the program's control plane API.
      *         Never returns null.
      */
@@ -920,7 +933,8 @@ class P4RuntimeAnalyzer {
                                 ReferenceMap* refMap,
                                 TypeMap* typeMap,
                                 P4RuntimeArchHandlerIface* archHandler,
-                                cstring arch);
+                                cstring arch,
+                                const std::vector<std::ostream*>& entriesStreams);
 
     void addAction(const IR::P4Action* actionDeclaration) {
         if (isHidden(actionDeclaration)) return;
@@ -1441,13 +1455,16 @@ static void analyzeParser(P4RuntimeAnalyzer& analyzer,
 
 /// A converter which translates the 'const entries' for P4 tables (if any)
 /// into a P4Runtime WriteRequest message which can be used by a target to
-/// initialize its tables.
+/// initialize its tables. If streams are provided, each entry is instead
+/// written to them as a length-delimited P4Runtime Update message as soon as
+/// it is converted, and the WriteRequest message stays empty.
 class P4RuntimeEntriesConverter {
  private:
     friend class P4RuntimeAnalyzer;
 
-    explicit P4RuntimeEntriesConverter(const P4RuntimeSymbolTable& symbols)
-        : entries(new p4v1::WriteRequest), symbols(symbols) { }
+    P4RuntimeEntriesConverter(const P4RuntimeSymbolTable& symbols,
+                              const std::vector<std::ostream*>& streams)
+        : entries(new p4v1::WriteRequest), symbols(symbols), streams(streams) { }
 
     /// @return the P4Runtime WriteRequest message generated by this analyzer.
     const p4v1::WriteRequest* getEntries() const {
@@ -1469,13 +1486,24 @@ class P4RuntimeEntriesConverter {
 
         int entryPriority = entriesList->entries.size();
         auto needsPriority = tableNeedsPriority(table, refMap);
+        auto keyColumns = getKeyColumns(table, refMap, typeMap);
+        // When streaming, a single Update message is reused for all entries.
+        p4v1::Update streamedUpdate;
+        if (streams.empty())
+            entries->mutable_updates()->Reserve(entries->updates_size() + entryPriority);
         for (auto e : entriesList->entries) {
-            auto protoUpdate = entries->add_updates();
+            p4v1::Update* protoUpdate;
+            if (streams.empty()) {
+                protoUpdate = entries->add_updates();
+            } else {
+                protoUpdate = &streamedUpdate;
+                protoUpdate->Clear();
+            }
             protoUpdate->set_type(p4v1::Update::INSERT);
             auto protoEntity = protoUpdate->mutable_entity();
             auto protoEntry = protoEntity->mutable_table_entry();
             protoEntry->set_table_id(tableId);
-            addMatchKey(protoEntry, table, e->getKeys(), refMap, typeMap);
+            addMatchKey(protoEntry, keyColumns, e->getKeys(), typeMap);
             addAction(protoEntry, e->getAction(), refMap, typeMap);
             // According to the P4 specification, "Entries in a table are
             // matched in the program order, stopping at the first matching
@@ -1492,6 +1520,12 @@ class P4RuntimeEntriesConverter {
                           "The @priority annotation on %1% is not part of the P4 specification, "
                           "nor of the P4Runtime specification, and will be ignored", e);
             }
+
+            for (auto stream : streams) {
+                if (!writers::writeDelimitedTo(*protoUpdate, stream))
+                    ::error(ErrorType::ERR_IO,
+                            "Failed to write the P4Runtime static table entry %1%", e);
+            }
         }
     }
 
@@ -1549,17 +1583,34 @@ class P4RuntimeEntriesConverter {
         }
     }
 
+    /// The match kind and width of one key field of a table; these are the
+    /// same for all the entries of the table.
+    struct KeyColumn {
+        cstring matchType;
+        int width;
+    };
+
+    std::vector<KeyColumn> getKeyColumns(const IR::P4Table* table,
+                                         ReferenceMap* refMap,
+                                         TypeMap* typeMap) const {
+        std::vector<KeyColumn> columns;
+        for (auto tableKey : table->getKey()->keyElements)
+            columns.push_back({ getKeyMatchType(tableKey, refMap),
+                                getTypeWidth(tableKey->expression->type, typeMap) });
+        return columns;
+    }
+
     void addMatchKey(p4v1::TableEntry* protoEntry,
-                     const IR::P4Table* table,
+                     const std::vector<KeyColumn>& keyColumns,
                      const IR::ListExpression* keyset,
-                     ReferenceMap* refMap,
                      TypeMap* typeMap) const {
-        int keyIndex = 0;
+        size_t keyIndex = 0;
         int fieldId = 1;
         for (auto k : keyset->components) {
-            auto tableKey = table->getKey()->keyElements.at(keyIndex++);
-            auto keyWidth = getTypeWidth(tableKey->expression->type, typeMap);
-            auto matchType = getKeyMatchType(tableKey, refMap);
+            BUG_CHECK(keyIndex < keyColumns.size(), "%1%: too many keys in entry", keyset);
+            auto keyWidth = keyColumns[keyIndex].width;
+            auto matchType = keyColumns[keyIndex].matchType;
+            keyIndex++;
 
             if (matchType == P4CoreLibrary::instance.exactMatch.name) {
               addExact(protoEntry, fieldId++, k, keyWidth, typeMap);
@@ -1784,6 +1835,8 @@ class P4RuntimeEntriesConverter {
     p4v1::WriteRequest *entries;
     /// The symbols used in the API and their ids.
     const P4RuntimeSymbolTable& symbols;
+    /// Streams to which entries are written as they are converted.
+    const std::vector<std::ostream*>& streams;
 };
 
 /* static */ P4RuntimeAPI
@@ -1792,7 +1845,8 @@ P4RuntimeAnalyzer::analyze(const IR::P4Program* program,
                            ReferenceMap* refMap,
                            TypeMap* typeMap,
                            P4RuntimeArchHandlerIface* archHandler,
-                           cstring arch) {
+                           cstring arch,
+                           const std::vector<std::ostream*>& entriesStreams) {
     using namespace ControlPlaneAPI;
 
     CHECK_NULL(archHandler);
@@ -1856,7 +1910,7 @@ P4RuntimeAnalyzer::analyze(const IR::P4Program* program,
 
     analyzer.addPkgInfo(evaluatedProgram, arch);
 
-    P4RuntimeEntriesConverter entriesConverter(symbols);
+    P4RuntimeEntriesConverter entriesConverter(symbols, entriesStreams);
     Helpers::forAllEvaluatedBlocks(evaluatedProgram, [&](const IR::Block* block) {
         if (block->is<IR::TableBlock>())
             entriesConverter.addTableEntries(block->to<IR::TableBlock>(), refMap,
@@ -1872,6 +1926,12 @@ P4RuntimeAnalyzer::analyze(const IR::P4Program* program,
 
 P4RuntimeAPI
 P4RuntimeSerializer::generateP4Runtime(const IR::P4Program* program, cstring arch) {
+    return generateP4Runtime(program, arch, {});
+}
+
+P4RuntimeAPI
+P4RuntimeSerializer::generateP4Runtime(const IR::P4Program* program, cstring arch,
+                                       const std::vector<std::ostream*>& entriesStreams) {
     using namespace ControlPlaneAPI;
 
     auto archHandlerBuilderIt = archHandlerBuilders.find(arch);
@@ -1905,8 +1965,12 @@ P4RuntimeSerializer::generateP4Runtime(const IR::P4Program* program, cstring arc
 
     auto archHandler = (*archHandlerBuilderIt->second)(&refMap, &typeMap, evaluatedProgram);
 
-    return P4RuntimeAnalyzer::analyze(p4RuntimeProgram, evaluatedProgram,
-                                      &refMap, &typeMap, archHandler, arch);
+    auto p4Runtime = P4RuntimeAnalyzer::analyze(p4RuntimeProgram, evaluatedProgram,
+                                                &refMap, &typeMap, archHandler, arch,
+                                                entriesStreams);
+    for (auto stream : entriesStreams)
+        stream->flush();
+    return p4Runtime;
 }
 
 void P4RuntimeAPI::serializeP4InfoTo(std::ostream* destination, P4RuntimeFormat format) const {
@@ -1924,6 +1988,10 @@ void P4RuntimeAPI::serializeP4InfoTo(std::ostream* destination, P4RuntimeFormat
         case P4RuntimeFormat::TEXT:
             success = writers::writeTextTo(*p4Info, destination);
             break;
+        case P4RuntimeFormat::DELIMITED:
+            success = writers::writeDelimitedTo(*p4Info, destination);
+            destination->flush();
+            break;
     }
     if (!success)
         ::error(ErrorType::ERR_IO, "Failed to serialize the P4Runtime API to the output");
@@ -1944,6 +2012,13 @@ void P4RuntimeAPI::serializeEntriesTo(std::ostream* destination, P4RuntimeFormat
         case P4RuntimeFormat::TEXT:
             success = writers::writeTextTo(*entries, destination);
             break;
+        case P4RuntimeFormat::DELIMITED:
+            for (const auto& update : entries->updates()) {
+                success = writers::writeDelimitedTo(update, destination);
+                if (!success) break;
+            }
+            destination->flush();
+            break;
     }
     if (!success)
         ::error(ErrorType::ERR_IO,
@@ -1971,6 +2046,8 @@ static bool parseFileNames(cstring fileNameVector,
                 formats.push_back(P4::P4RuntimeFormat::BINARY);
             } else if (suffix == ".txt") {
                 formats.push_back(P4::P4RuntimeFormat::TEXT);
+            } else if (suffix == ".delimited") {
+                formats.push_back(P4::P4RuntimeFormat::DELIMITED);
             } else {
                 ::error(ErrorType::ERR_UNKNOWN,
                         "%1%: Could not detect p4runtime info file format from file suffix %2%",
@@ -1979,13 +2056,26 @@ static bool parseFileNames(cstring fileNameVector,
             }
         } else {
             ::error(ErrorType::ERR_UNKNOWN,
-                    "%1%: unknown file kind; known suffixes are .bin, .txt, .json", name);
+                    "%1%: unknown file kind; known suffixes are .bin, .txt, .json, .delimited",
+                    name);
             return false;
         }
     }
     return true;
 }
 
+/// Collects the files to which the P4Runtime static table entries must be
+/// written, along with their formats, from the command-line @options.
+static bool getEntriesFiles(const CompilerOptions& options,
+                            std::vector<cstring> &files,
+                            std::vector<P4::P4RuntimeFormat> &formats) {
+    if (!options.p4RuntimeEntriesFile.isNullOrEmpty()) {
+        files.push_back(options.p4RuntimeEntriesFile);
+        formats.push_back(options.p4RuntimeFormat);
+    }
+    return parseFileNames(options.p4RuntimeEntriesFiles, files, formats);
+}
+
 void
 P4RuntimeSerializer::serializeP4RuntimeIfRequired(const IR::P4Program* program,
                                                   const CompilerOptions& options) {
@@ -2002,59 +2092,87 @@ P4RuntimeSerializer::serializeP4RuntimeIfRequired(const IR::P4Program* program,
     auto arch = P4RuntimeSerializer::resolveArch(options);
     if (Log::verbose())
         std::cout << "Generating P4Runtime output for architecture " << arch << std::endl;
-    auto p4Runtime = get()->generateP4Runtime(program, arch);
-    serializeP4RuntimeIfRequired(p4Runtime, options);
+
+    // If all the static table entries go to delimited files, the entries are
+    // streamed to the files while they are converted and are never held in
+    // memory all at once.
+    if (!getEntriesFiles(options, files, formats))
+        return;
+    bool streamEntries = !files.empty() &&
+        std::all_of(formats.begin(), formats.end(), [](P4::P4RuntimeFormat format) {
+            return format == P4::P4RuntimeFormat::DELIMITED; });
+    if (!streamEntries) {
+        auto p4Runtime = get()->generateP4Runtime(program, arch);
+        serializeP4RuntimeIfRequired(p4Runtime, options);
+        return;
+    }
+
+    std::vector<std::ostream*> streams;
+    for (auto file : files) {
+        std::ostream* out = openFile(file, false);
+        if (!out) {
+            ::error(ErrorType::ERR_IO, "Couldn't open P4Runtime static entries file: %1%",
+                    file);
+            continue;
+        }
+        streams.push_back(out);
+    }
+    auto p4Runtime = get()->generateP4Runtime(program, arch, streams);
+    serializeP4InfoIfRequired(p4Runtime, options);
 }
 
 void
 P4RuntimeSerializer::serializeP4RuntimeIfRequired(const P4RuntimeAPI& p4Runtime,
                                                   const CompilerOptions& options) {
+    if (!serializeP4InfoIfRequired(p4Runtime, options))
+        return;
+
+    // Do the same for the entries files
     std::vector<cstring> files;
     std::vector<P4::P4RuntimeFormat> formats;
-
-    if (!options.p4RuntimeFile.isNullOrEmpty()) {
-        files.push_back(options.p4RuntimeFile);
-        formats.push_back(options.p4RuntimeFormat);
-    }
-    if (!parseFileNames(options.p4RuntimeFiles, files, formats))
+    if (!getEntriesFiles(options, files, formats))
         return;
-
     if (!files.empty()) {
         for (unsigned i = 0; i < files.size(); i++) {
             cstring file = files.at(i);
             P4::P4RuntimeFormat format = formats.at(i);
             std::ostream* out = openFile(file, false);
             if (!out) {
-                ::error(ErrorType::ERR_IO, "Couldn't open P4Runtime API file: %1%", file);
+                ::error(ErrorType::ERR_IO, "Couldn't open P4Runtime static entries file: %1%",
+                        options.p4RuntimeEntriesFile);
                 continue;
             }
-            p4Runtime.serializeP4InfoTo(out, format);
+            p4Runtime.serializeEntriesTo(out, format);
         }
     }
+}
 
-    // Do the same for the entries files
-    files.clear();
-    formats.clear();
-    if (!options.p4RuntimeEntriesFile.isNullOrEmpty()) {
-        files.push_back(options.p4RuntimeEntriesFile);
+bool
+P4RuntimeSerializer::serializeP4InfoIfRequired(const P4RuntimeAPI& p4Runtime,
+                                               const CompilerOptions& options) {
+    std::vector<cstring> files;
+    std::vector<P4::P4RuntimeFormat> formats;
+
+    if (!options.p4RuntimeFile.isNullOrEmpty()) {
+        files.push_back(options.p4RuntimeFile);
         formats.push_back(options.p4RuntimeFormat);
     }
+    if (!parseFileNames(options.p4RuntimeFiles, files, formats))
+        return false;
 
-    if (!parseFileNames(options.p4RuntimeEntriesFiles, files, formats))
-        return;
     if (!files.empty()) {
         for (unsigned i = 0; i < files.size(); i++) {
             cstring file = files.at(i);
             P4::P4RuntimeFormat format = formats.at(i);
             std::ostream* out = openFile(file, false);
             if (!out) {
-                ::error(ErrorType::ERR_IO, "Couldn't open P4Runtime static entries file: %1%",
-                        options.p4RuntimeEntriesFile);
+                ::error(ErrorType::ERR_IO, "Couldn't open P4Runtime API file: %1%", file);
                 continue;
             }
-            p4Runtime.serializeEntriesTo(out, format);
+            p4Runtime.serializeP4InfoTo(out, format);
         }
     }
+    return true;
 }
 
 P4RuntimeSerializer::P4RuntimeSerializer() {
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <iosfwd>
 #include <unordered_map>
+#include <vector>
 
 #include "lib/cstring.h"
 
@@ -45,7 +46,11 @@ namespace P4 {
 enum class P4RuntimeFormat {
   BINARY,
   JSON,
-  TEXT
+  TEXT,
+  /// A sequence of binary messages, each prefixed by its varint-encoded size.
+  /// Static table entries are written as one p4::v1::Update message per
+  /// entry rather than as a single WriteRequest message.
+  DELIMITED
 };
 
 /// A P4 program's control-plane API, represented in terms of P4Runtime's data
@@ -92,6 +97,16 @@ class P4RuntimeSerializer {
      */
     P4RuntimeAPI generateP4Runtime(const IR::P4Program* program, cstring arch);
 
+    /**
+     * Like generateP4Runtime() above, but the static table entries are not
+     * accumulated in the returned P4RuntimeAPI (its WriteRequest is empty).
+     * Instead each entry is written to all the @entriesStreams as a
+     * length-delimited p4::v1::Update message as soon as it is converted, so
+     * that memory use does not grow with the number of entries.
+     */
+    P4RuntimeAPI generateP4Runtime(const IR::P4Program* program, cstring arch,
+                                   const std::vector<std::ostream*>& entriesStreams);
+
     /**
      * A convenience wrapper for P4::generateP4Runtime() which generates the
      * P4RuntimeAPI structure for the provided program and serializes it
@@ -122,6 +137,11 @@ class P4RuntimeSerializer {
  private:
     P4RuntimeSerializer();
 
+    /// Serializes the P4Info message of @p4Runtime to the files requested by
+    /// the command-line @options. @return false if the file list is invalid.
+    static bool serializeP4InfoIfRequired(const P4RuntimeAPI& p4Runtime,
+                                          const CompilerOptions& options);
+
     std::unordered_map<cstring, const ControlPlaneAPI::P4RuntimeArchHandlerBuilderIface*>
     archHandlerBuilders{};
 };
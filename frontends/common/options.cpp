@@ -113,7 +113,9 @@ CompilerOptions::CompilerOptions() : ParserOptions() {
         },
         "Write static table entries as a P4Runtime WriteRequest message\n"
         "to the specified files (comma-separated list); the file format is\n"
-        "inferred from the suffix. Legal suffixes are .json, .txt and .bin");
+        "inferred from the suffix. Legal suffixes are .json, .txt, .bin and\n"
+        ".delimited; the latter holds one length-delimited binary Update\n"
+        "message per entry.");
     registerOption(
         "--p4runtime-format", "{binary,json,text}",
         [this](const char* arg) {
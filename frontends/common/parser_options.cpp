@@ -26,6 +26,7 @@ limitations under the License.
 #include "ir/json_generator.h"
 #include "lib/exceptions.h"
 #include "lib/exename.h"
+#include "lib/gc.h"
 #include "lib/log.h"
 #include "lib/nullstream.h"
 #include "lib/path.h"
@@ -41,7 +42,8 @@ const char* p4_14includePath = CONFIG_PKGDATADIR "/p4_14include";
 
 const char* ParserOptions::defaultMessage = "Compile a P4 program";
 
-ParserOptions::ParserOptions() : Util::Options(defaultMessage) {
+ParserOptions::ParserOptions() : Util::Options(defaultMessage),
+                                 startTime(std::chrono::steady_clock::now()) {
     registerOption(
         "--help", nullptr,
         [this](const char* ) {
@@ -223,6 +225,15 @@ ParserOptions::ParserOptions() : Util::Options(defaultMessage) {
             return true;
         },
         "[Compiler debugging] Folder where P4 programs are dumped\n");
+    registerOption(
+        "--timing-log", "file",
+        [this](const char* arg) {
+            timingLog = openFile(arg, false);
+            return timingLog != nullptr;
+        },
+        "[Compiler debugging] Write to file the time (in microseconds since the\n"
+        "compiler started), the GC heap size and the iterations saved by\n"
+        "worklist PassRepeated loops after each pass\n");
     registerUsage(
         "loglevel format is: \"sourceFile:level,...,sourceFile:level\"\n"
         "where 'sourceFile' is a compiler source file and "
@@ -394,6 +405,16 @@ void ParserOptions::dumpPass(const char* manager, unsigned seq,
     if (Log::verbose())
         std::cerr << name << std::endl;
 
+    if (timingLog) {
+        auto now = std::chrono::steady_clock::now();
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - startTime);
+        // a worklist PassRepeated adds its savings when it converges, so they
+        // are reported on the line of the pass that ran it
+        double saved = PassRepeated::totalIterationsSaved();
+        *timingLog << manager << '\t' << pass << '\t' << us.count() << '\t'
+                   << gc_heap_size() << '\t' << saved - timingSaved << std::endl;
+        timingSaved = saved; }
+
     for (auto s : top4) {
         bool match = false;
         try {
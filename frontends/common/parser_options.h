@@ -19,6 +19,7 @@ limitations under the License.
 #ifndef FRONTENDS_COMMON_PARSER_OPTIONS_H_
 #define FRONTENDS_COMMON_PARSER_OPTIONS_H_
 
+#include <chrono>
 #include <set>
 #include <unordered_map>
 
@@ -43,6 +44,12 @@ class ParserOptions : public Util::Options {
     // annotation names that are to be ignored by the compiler
     std::set<cstring> disabledAnnotations;
 
+    // where --timing-log writes the time at which each pass ended
+    std::ostream* timingLog = nullptr;
+    std::chrono::steady_clock::time_point startTime;
+    // PassRepeated::totalIterationsSaved() when the last timing line was written
+    mutable double timingSaved = 0;
+
  protected:
     // Function that is returned by getDebugHook.
     void dumpPass(const char* manager, unsigned seq, const char* pass,
@@ -20,10 +20,51 @@ limitations under the License.
 
 namespace P4 {
 
-MinimalNameGenerator::MinimalNameGenerator() {
-    usedNames.insert(P4::reservedWords.begin(), P4::reservedWords.end());
+UsedNames::UsedNames() {
+    clear();
 }
 
+void UsedNames::clear() {
+    names.clear();
+    nextSuffix.clear();
+    names.insert(P4::reservedWords.begin(), P4::reservedWords.end());
+}
+
+cstring UsedNames::newName(cstring base) {
+    // Maybe in the future we'll maintain information with per-scope identifiers,
+    // but today we are content to generate globally-unique identifiers.
+
+    // If base has a suffix of the form _(\d+), then we discard the suffix.
+    // under the assumption that it is probably a generated suffix.
+    // This will not impact correctness.
+    unsigned len = base.size();
+    const char digits[] = "0123456789";
+    const char* s = base.c_str();
+    while (len > 0 && strchr(digits, s[len-1])) len--;
+    if (len > 0 && base[len - 1] == '_')
+        base = base.substr(0, len - 1);
+
+    // Same names as cstring::make_unique(names, base, '_'), but without probing
+    // the suffixes already handed out, nor interning the candidates we reject.
+    if (!count(base)) {
+        insert(base);
+        return base; }
+    unsigned &next = nextSuffix[base];
+    std::string name = base + '_';
+    size_t prefix = name.size();
+    while (true) {
+        name.resize(prefix);
+        name += std::to_string(next++);
+        cstring used = cstring::get_interned(name);
+        if (!used || !count(used))
+            break; }
+    cstring rv = name;
+    insert(rv);
+    return rv;
+}
+
+MinimalNameGenerator::MinimalNameGenerator() {}
+
 ReferenceMap::ReferenceMap() : ProgramMap("ReferenceMap"), isv1(false) { clear(); }
 
 void ReferenceMap::clear() {
@@ -31,7 +72,6 @@ void ReferenceMap::clear() {
     usedNames.clear();
     used.clear();
     thisToDeclaration.clear();
-    usedNames.insert(P4::reservedWords.begin(), P4::reservedWords.end());
 }
 
 void ReferenceMap::setDeclaration(const IR::Path* path, const IR::IDeclaration* decl) {
@@ -94,41 +134,11 @@ void ReferenceMap::dbprint(std::ostream &out) const {
 }
 
 cstring ReferenceMap::newName(cstring base) {
-    // Maybe in the future we'll maintain information with per-scope identifiers,
-    // but today we are content to generate globally-unique identifiers.
-
-    // If base has a suffix of the form _(\d+), then we discard the suffix.
-    // under the assumption that it is probably a generated suffix.
-    // This will not impact correctness.
-    unsigned len = base.size();
-    const char digits[] = "0123456789";
-    const char* s = base.c_str();
-    while (len > 0 && strchr(digits, s[len-1])) len--;
-    if (len > 0 && base[len - 1] == '_')
-        base = base.substr(0, len - 1);
-
-    cstring name = cstring::make_unique(usedNames, base, '_');
-    usedNames.insert(name);
-    return name;
+    return usedNames.newName(base);
 }
 
 cstring MinimalNameGenerator::newName(cstring base) {
-    // Maybe in the future we'll maintain information with per-scope identifiers,
-    // but today we are content to generate globally-unique identifiers.
-
-    // If base has a suffix of the form _(\d+), then we discard the suffix.
-    // under the assumption that it is probably a generated suffix.
-    // This will not impact correctness.
-    unsigned len = base.size();
-    const char digits[] = "0123456789";
-    const char* s = base.c_str();
-    while (len > 0 && strchr(digits, s[len-1])) len--;
-    if (len > 0 && base[len - 1] == '_')
-        base = base.substr(0, len - 1);
-
-    cstring name = cstring::make_unique(usedNames, base, '_');
-    usedNames.insert(name);
-    return name;
+    return usedNames.newName(base);
 }
 
 }  // namespace P4
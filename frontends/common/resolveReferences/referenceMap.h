@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef _COMMON_RESOLVEREFERENCES_REFERENCEMAP_H_
 #define _COMMON_RESOLVEREFERENCES_REFERENCEMAP_H_
 
+#include <unordered_map>
 #include "ir/ir.h"
 #include "lib/cstring.h"
 #include "lib/map.h"
@@ -29,9 +30,27 @@ class NameGenerator {
     virtual cstring newName(cstring base) = 0;
 };
 
+/// The names used in a program, from which fresh names are generated.
+class UsedNames {
+    /// Only membership matters, so the names are ordered by intern id.
+    std::set<cstring, cstring::id_less> names;
+    /// For each base name, the next suffix newName() tries.  Names are never removed
+    /// (except by clear), so all the names with a lower suffix are known to be used.
+    std::unordered_map<cstring, unsigned> nextSuffix;
+
+ public:
+    UsedNames();
+    void insert(cstring name) { names.insert(name); }
+    bool count(cstring name) const { return names.count(name) != 0; }
+    /// Forget all names except the reserved words.
+    void clear();
+    /// Generate a name from @p base that is not used yet, and mark it as used.
+    cstring newName(cstring base);
+};
+
 // replacement for ReferenceMap NameGenerator to make it easier to remove uses of refMap
 class MinimalNameGenerator : public NameGenerator, public Inspector {
-    std::set<cstring> usedNames;
+    UsedNames usedNames;
     void usedName(cstring name) { usedNames.insert(name); }
     void postorder(const IR::Path *p) override { usedName(p->name.name); }
     void postorder(const IR::Type_Declaration *t) override { usedName(t->name.name); }
@@ -73,7 +92,7 @@ class ReferenceMap final : public ProgramMap, public NameGenerator, public Decla
     std::map<const IR::This*, const IR::IDeclaration*> thisToDeclaration;
 
     /// Set containing all names used in the program.
-    std::set<cstring> usedNames;
+    UsedNames usedNames;
 
  public:
     ReferenceMap();
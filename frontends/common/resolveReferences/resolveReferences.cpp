@@ -19,6 +19,7 @@ limitations under the License.
 #include <sstream>
 #include <boost/range/adaptor/reversed.hpp>
 #include "frontends/common/options.h"
+#include "lib/iterator_range.h"
 
 namespace P4 {
 
@@ -45,51 +46,51 @@ ResolutionContext::lookup(const IR::INamespace *current, IR::ID name,
     LOG2("Trying to resolve in " << current->toString());
 
     if (auto gen = current->to<IR::IGeneralNamespace>()) {
-        Util::Enumerator<const IR::IDeclaration*> *decls = gen->getDeclsByName(name);
+        std::vector<const IR::IDeclaration*> named;
+        gen->getDeclsByName(name, named);
         switch (type) {
             case P4::ResolutionType::Any:
+            case P4::ResolutionType::Type:
+            case P4::ResolutionType::TypeVariable:
                 break;
-            case P4::ResolutionType::Type: {
-                std::function<bool(const IR::IDeclaration*)> kindFilter =
-                        [](const IR::IDeclaration *d) {
-                    return d->is<IR::Type>(); };
-                decls = decls->where(kindFilter);
-                break; }
-            case P4::ResolutionType::TypeVariable: {
-                std::function<bool(const IR::IDeclaration*)> kindFilter =
-                        [](const IR::IDeclaration *d) {
-                return d->is<IR::Type_Var>(); };
-                decls = decls->where(kindFilter);
-                break; }
         default:
             BUG("Unexpected enumeration value %1%", static_cast<int>(type)); }
 
-        if (!anyOrder && name.srcInfo.isValid()) {
-            std::function<bool(const IR::IDeclaration*)> locationFilter =
-                    [this, name, type](const IR::IDeclaration *d) {
-                if (d->is<IR::Type_Var>() || d->is<IR::ParserState>())
-                    // type vars and parser states may be used before their definitions
-                    return true;
-                Util::SourceInfo nsi = name.srcInfo;
-                Util::SourceInfo dsi = d->getNode()->srcInfo;
-                bool before = dsi <= nsi;
-                LOG3("\tPosition test:" << dsi << "<=" << nsi << "=" << before);
-
-                if (type == ResolutionType::Type) {
-                    if (auto *type_decl = findContext<IR::Type_Declaration>())
-                        if (type_decl->getNode() == d->getNode()) {
-                            ::error(ErrorType::ERR_UNSUPPORTED,
-                                "Self-referencing types not supported: '%1%' within '%2%'",
-                                name, d->getNode()); }
-                } else if (type == ResolutionType::Any) {
-                    if (auto *decl_ctxt = findContext<IR::Declaration>())
-                        if (decl_ctxt->getNode() == d->getNode())
-                            before = false; }
-
-                return before; };
-            decls = decls->where(locationFilter); }
-
-        auto vector = decls->toVector();
+        auto kindFilter = [type](const IR::IDeclaration *d) -> bool {
+            if (type == P4::ResolutionType::Type)
+                return d->is<IR::Type>();
+            if (type == P4::ResolutionType::TypeVariable)
+                return d->is<IR::Type_Var>();
+            return true; };
+
+        bool checkLocation = !anyOrder && name.srcInfo.isValid();
+        auto locationFilter = [this, name, type, checkLocation](const IR::IDeclaration *d) -> bool {
+            if (!checkLocation)
+                return true;
+            if (d->is<IR::Type_Var>() || d->is<IR::ParserState>())
+                // type vars and parser states may be used before their definitions
+                return true;
+            Util::SourceInfo nsi = name.srcInfo;
+            Util::SourceInfo dsi = d->getNode()->srcInfo;
+            bool before = dsi <= nsi;
+            LOG3("\tPosition test:" << dsi << "<=" << nsi << "=" << before);
+
+            if (type == ResolutionType::Type) {
+                if (auto *type_decl = findContext<IR::Type_Declaration>())
+                    if (type_decl->getNode() == d->getNode()) {
+                        ::error(ErrorType::ERR_UNSUPPORTED,
+                            "Self-referencing types not supported: '%1%' within '%2%'",
+                            name, d->getNode()); }
+            } else if (type == ResolutionType::Any) {
+                if (auto *decl_ctxt = findContext<IR::Declaration>())
+                    if (decl_ctxt->getNode() == d->getNode())
+                        before = false; }
+
+            return before; };
+
+        // The filters are composed without allocating; only the result vector is.
+        auto vector = new std::vector<const IR::IDeclaration*>(
+            Util::make_range(named).where(kindFilter).where(locationFilter).toVector());
         if (!vector->empty()) {
             LOG3("Resolved in " << dbp(current->getNode()));
             return vector; }
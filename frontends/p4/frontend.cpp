@@ -132,6 +132,13 @@ const IR::P4Program *FrontEnd::run(const CompilerOptions &options, const IR::P4P
     refMap.setIsV1(isv1);
 
     auto evaluator = new P4::EvaluatorPass(&refMap, &typeMap);
+    // The passes wrapped in PerDeclaration (here and inside SimplifyControlFlow,
+    // StrengthReduction, UselessCasts and SideEffectOrdering) are known to
+    // rewrite each top-level declaration independently of the others, so the
+    // PassRepeated worklists only reapply them to the declarations that changed.
+    // Those marked setParallel() also share no state between declarations, and
+    // run concurrently in MULTITHREAD builds; MoveDeclarations and the
+    // SideEffectOrdering passes allocate names through the shared ReferenceMap.
     PassManager passes({
         new P4V1::getV1ModelVersion,
         // Parse annotations
@@ -165,12 +172,12 @@ const IR::P4Program *FrontEnd::run(const CompilerOptions &options, const IR::P4P
         new StructInitializers(&refMap, &typeMap),
         new SpecializeGenericFunctions(&refMap, &typeMap),
         new TableKeyNames(&refMap, &typeMap),
-        PassRepeated({
+        (new PassRepeated({
             new ConstantFolding(&refMap, &typeMap),
             new StrengthReduction(&refMap, &typeMap),
-            new Reassociation(),
+            (new PerDeclaration(new Reassociation()))->setParallel(),
             new UselessCasts(&refMap, &typeMap)
-        }),
+        }))->setWorklist(),
         new SimplifyControlFlow(&refMap, &typeMap),
         new SwitchAddDefault,
         new FrontEndDump(),  // used for testing the program at this point
@@ -178,12 +185,12 @@ const IR::P4Program *FrontEnd::run(const CompilerOptions &options, const IR::P4P
         new SimplifyParsers(&refMap),
         new ResetHeaders(&refMap, &typeMap),
         new UniqueNames(&refMap),  // Give each local declaration a unique internal name
-        new MoveDeclarations(),  // Move all local declarations to the beginning
+        new PerDeclaration(new MoveDeclarations()),  // Move all local declarations to the beginning
         new MoveInitializers(&refMap),
         new SideEffectOrdering(&refMap, &typeMap, skipSideEffectOrdering),
         new SimplifyControlFlow(&refMap, &typeMap),
         new SimplifySwitch(&refMap, &typeMap),
-        new MoveDeclarations(),  // Move all local declarations to the beginning
+        new PerDeclaration(new MoveDeclarations()),  // Move all local declarations to the beginning
         new SimplifyDefUse(&refMap, &typeMap),
         new UniqueParameters(&refMap, &typeMap),
         new SimplifyControlFlow(&refMap, &typeMap),
@@ -211,7 +218,7 @@ const IR::P4Program *FrontEnd::run(const CompilerOptions &options, const IR::P4P
         new SimplifyControlFlow(&refMap, &typeMap),
         new RemoveParserControlFlow(&refMap, &typeMap),  // more ifs may have been added to parsers
         new UniqueNames(&refMap),  // needed again after inlining
-        new MoveDeclarations(),  // needed again after inlining
+        new PerDeclaration(new MoveDeclarations()),  // needed again after inlining
         new SimplifyControlFlow(&refMap, &typeMap),
         new HierarchicalNames(),
         new FrontEndLast(),
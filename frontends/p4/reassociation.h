@@ -27,6 +27,7 @@ namespace P4 {
 class Reassociation final : public Transform {
  public:
     Reassociation() { visitDagOnce = true; setName("Reassociation"); }
+    Reassociation* clone() const override { return new Reassociation(*this); }
     using Transform::postorder;
 
     const IR::Node* reassociate(IR::Operation_Binary* root);
@@ -357,11 +357,13 @@ class SideEffectOrdering : public PassRepeated {
             typeChecking = new TypeChecking(refMap, typeMap);
         if (!skipSideEffectOrdering) {
             passes.push_back(new TypeChecking(refMap, typeMap));
-            passes.push_back(new DoSimplifyExpressions(refMap, typeMap, &added));
+            passes.push_back(new PerDeclaration(
+                new DoSimplifyExpressions(refMap, typeMap, &added)));
             passes.push_back(typeChecking);
             passes.push_back(new TablesInKeys(refMap, typeMap, &invokedInKey));
             passes.push_back(new KeySideEffect(refMap, typeMap, &invokedInKey));
         }
+        setWorklist();
         setName("SideEffectOrdering");
     }
 };
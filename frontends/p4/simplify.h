@@ -60,6 +60,7 @@ class DoSimplifyControlFlow : public Transform {
         // in different places.
         visitDagOnce = false;
     }
+    DoSimplifyControlFlow* clone() const override { return new DoSimplifyControlFlow(*this); }
     const IR::Node* postorder(IR::BlockStatement* statement) override;
     const IR::Node* postorder(IR::IfStatement* statement) override;
     const IR::Node* postorder(IR::EmptyStatement* statement) override;
@@ -75,7 +76,9 @@ class SimplifyControlFlow : public PassRepeated {
         if (!typeChecking)
             typeChecking = new TypeChecking(refMap, typeMap);
         passes.push_back(typeChecking);
-        passes.push_back(new DoSimplifyControlFlow(refMap, typeMap));
+        passes.push_back((new PerDeclaration(new DoSimplifyControlFlow(refMap, typeMap)))
+                         ->setParallel());
+        setWorklist();
         setName("SimplifyControlFlow");
     }
 };
@@ -68,6 +68,7 @@ class DoStrengthReduction final : public Transform {
 
  public:
     DoStrengthReduction() { visitDagOnce = true; setName("StrengthReduction"); }
+    DoStrengthReduction* clone() const override { return new DoStrengthReduction(*this); }
 
     using Transform::postorder;
 
@@ -100,7 +101,7 @@ class StrengthReduction : public PassManager {
         if (!typeChecking)
             typeChecking = new TypeChecking(refMap, typeMap, true);
         passes.push_back(typeChecking);
-        passes.push_back(new DoStrengthReduction());
+        passes.push_back((new PerDeclaration(new DoStrengthReduction()))->setParallel());
     }
 };
 
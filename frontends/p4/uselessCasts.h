@@ -32,6 +32,7 @@ class RemoveUselessCasts : public Transform {
  public:
     explicit RemoveUselessCasts(const P4::TypeMap* typeMap): typeMap(typeMap)
     { CHECK_NULL(typeMap); setName("RemoveUselessCasts"); }
+    RemoveUselessCasts* clone() const override { return new RemoveUselessCasts(*this); }
     const IR::Node* postorder(IR::Cast* cast) override;
 };
 
@@ -39,7 +40,7 @@ class UselessCasts : public PassManager {
  public:
     UselessCasts(ReferenceMap* refMap, TypeMap* typeMap) {
         passes.push_back(new TypeChecking(refMap, typeMap));
-        passes.push_back(new RemoveUselessCasts(typeMap));
+        passes.push_back((new PerDeclaration(new RemoveUselessCasts(typeMap)))->setParallel());
         setName("UselessCasts");
     }
 };
@@ -21,6 +21,8 @@ limitations under the License.
 #include "dbprint.h"
 #include "lib/enumerator.h"
 #include "lib/error.h"
+#include "lib/iterator_range.h"
+#include "lib/map.h"
 #include "lib/null.h"
 #include "lib/safe_vector.h"
 #include "vector.h"
@@ -104,6 +106,11 @@ class IndexedVector : public Vector<T> {
     Util::Enumerator<const IDeclaration*>* getDeclarations() const {
         return Util::Enumerator<const IDeclaration*>::createEnumerator(
             Values(declarations).begin(), Values(declarations).end()); }
+    typedef typename IterValues<typename ordered_map<cstring, const IDeclaration*>::const_iterator>
+        ::iterator decl_iterator;
+    /// Same as getDeclarations(), without allocating an enumerator.
+    Util::iterator_range<decl_iterator> getDeclarationRange() const {
+        return Util::make_range(Values(declarations).begin(), Values(declarations).end()); }
     iterator erase(iterator i) {
         removeFromMap(*i);
         return Vector<T>::erase(i); }
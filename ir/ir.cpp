@@ -32,8 +32,8 @@ const cstring IApply::applyMethodName = "apply";
 const cstring P4Program::main = "main";
 const cstring Type_Error::error = "error";
 
-int IR::Declaration::nextId = 0;
-int IR::This::nextId = 0;
+IR::IdCounter IR::Declaration::nextId(0);
+IR::IdCounter IR::This::nextId(0);
 
 const Type_Method* P4Control::getConstructorMethodType() const {
     return new Type_Method(getTypeParameters(), type, constructorParams, getName());
@@ -54,6 +54,15 @@ Util::Enumerator<const IR::IDeclaration*>* IGeneralNamespace::getDeclsByName(cst
     return getDeclarations()->where(filter);
 }
 
+void IGeneralNamespace::getDeclsByName(cstring name,
+                                       std::vector<const IDeclaration*> &decls) const {
+    for (auto d : *getDeclarations()) {
+        CHECK_NULL(d);
+        if (name == d->getName().name)
+            decls.push_back(d);
+    }
+}
+
 Util::Enumerator<const IDeclaration*>* INestedNamespace::getDeclarations() const {
     Util::Enumerator<const IDeclaration*>* rv = nullptr;
     for (auto nested : getNestedNamespaces()) {
@@ -246,6 +255,35 @@ Util::Enumerator<const IDeclaration*>* P4Program::getDeclarations() const {
             ->where([](const IDeclaration* d) { return d != nullptr; });
 }
 
+const std::vector<const IDeclaration*> *P4Program::findDecls(cstring name) const {
+    // The size check catches objects added or removed without visiting them.
+    if (!declsByName.byName || declsByName.size != objects.size()) {
+        auto byName = new std::unordered_map<cstring, std::vector<const IDeclaration*>>;
+        for (auto obj : objects) {
+            if (auto decl = obj->to<IDeclaration>())
+                (*byName)[decl->getName().name].push_back(decl);
+        }
+        declsByName.byName = byName;
+        declsByName.size = objects.size();
+    }
+    auto it = declsByName.byName->find(name);
+    if (it == declsByName.byName->end())
+        return nullptr;
+    return &it->second;
+}
+
+Util::Enumerator<const IDeclaration*>* P4Program::getDeclsByName(cstring name) const {
+    auto decls = findDecls(name);
+    if (!decls)
+        return new Util::EmptyEnumerator<const IDeclaration*>;
+    return Util::Enumerator<const IDeclaration*>::createEnumerator(decls->begin(), decls->end());
+}
+
+void P4Program::getDeclsByName(cstring name, std::vector<const IDeclaration*> &decls) const {
+    if (auto found = findDecls(name))
+        decls.insert(decls.end(), found->begin(), found->end());
+}
+
 const IR::PackageBlock* ToplevelBlock::getMain() const {
     auto program = getProgram();
     auto mainDecls = program->getDeclsByName(IR::P4Program::main)->toVector();
@@ -20,6 +20,7 @@ limitations under the License.
 #include <strings.h>
 #include <cassert>
 #include <sstream>
+#include <unordered_map>
 
 #include "lib/log.h"
 #include "lib/null.h"
@@ -24,7 +24,7 @@ void IR::Node::traceVisit(const char* visitor) const
 
 void IR::Node::traceCreation() const { LOG5("Created node " << id); }
 
-int IR::Node::currentId = 0;
+IR::IdCounter IR::Node::currentId(0);
 
 void IR::Node::toJSON(JSONGenerator &json) const {
     json << json.indent << "\"Node_ID\" : " << id << "," << std::endl
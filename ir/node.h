@@ -18,6 +18,9 @@ limitations under the License.
 #define _IR_NODE_H_
 
 #include <memory>
+#ifdef MULTITHREAD
+#include <atomic>
+#endif  // MULTITHREAD
 #include "lib/cstring.h"
 #include "lib/stringify.h"
 #include "lib/indent.h"
@@ -41,6 +44,14 @@ class Annotation;
 
 template<class T> class Vector;
 template<class T> class IndexedVector;
+
+// source of node and declaration ids, which may be handed out on several threads
+#ifdef MULTITHREAD
+typedef std::atomic<int> IdCounter;
+#else
+typedef int IdCounter;
+#endif  // MULTITHREAD
+
 // node interface
 class INode : public Util::IHasSourceInfo, public IHasDbPrint {
  public:
@@ -83,7 +94,7 @@ class Node : public virtual INode {
     Node &operator=(Node &&) = default;
 
  protected:
-    static int currentId;
+    static IdCounter currentId;
     void traceVisit(const char* visitor) const;
     virtual void visit_children(Visitor &) { }
     virtual void visit_children(Visitor &) const { }
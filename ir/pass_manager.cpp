@@ -14,6 +14,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#ifdef MULTITHREAD
+#include <atomic>
+#include <exception>
+#include <thread>
+#endif  // MULTITHREAD
+
 #include "ir.h"
 #include "lib/gc.h"
 #include "lib/n4.h"
@@ -118,18 +124,103 @@ bool PassManager::never_backtracks() {
     return true;
 }
 
+void PassManager::setSkippedDeclarations(const std::set<const IR::Node *> *skip) {
+    for (auto pass : passes) {
+        if (auto per = dynamic_cast<PerDeclaration *>(pass)) {
+            per->setSkippedDeclarations(skip);
+        } else if (auto child = dynamic_cast<PassManager *>(pass)) {
+            auto repeated = dynamic_cast<PassRepeated *>(pass);
+            if (!repeated || !repeated->hasWorklist())
+                child->setSkippedDeclarations(skip); } }
+}
+
 void PassManager::runDebugHooks(const char* visitorName, const IR::Node* program) {
     for (auto h : debugHooks)
         h(name(), seqNo, visitorName, program);
 }
 
+namespace {
+class UsedNames : public Inspector {
+ public:
+    std::set<cstring> &names;
+    explicit UsedNames(std::set<cstring> &names) : names(names) {}
+    bool preorder(const IR::Path *path) override {
+        names.insert(path->name.name);
+        return false; }
+};
+
+cstring declarationName(const IR::Node *node) {
+    if (auto decl = node->to<IR::IDeclaration>())
+        return decl->getName().name;
+    return cstring();
+}
+}  // namespace
+
+unsigned PassRepeated::totalSkipped = 0;
+double PassRepeated::totalSaved = 0;
+
+// Computes the objects of 'after' that the next repeat may skip: those that were
+// already objects of 'before', and use none of the names declared by the objects
+// that were added or removed.
+void PassRepeated::updateWorklist(const IR::Node *before, const IR::Node *after,
+                                  std::set<const IR::Node *> &unchanged) {
+    unchanged.clear();
+    auto oldProgram = before->to<IR::P4Program>();
+    auto newProgram = after->to<IR::P4Program>();
+    if (!oldProgram || !newProgram)
+        return;
+    std::set<const IR::Node *> oldObjects(oldProgram->objects.begin(),
+                                          oldProgram->objects.end());
+    std::set<const IR::Node *> newObjects(newProgram->objects.begin(),
+                                          newProgram->objects.end());
+    std::set<cstring> changed;
+    for (auto obj : newProgram->objects)
+        if (!oldObjects.count(obj))
+            changed.insert(declarationName(obj));
+    for (auto obj : oldProgram->objects)
+        if (!newObjects.count(obj)) {
+            changed.insert(declarationName(obj));
+            usedNames.erase(obj); }
+    changed.erase(cstring());
+
+    for (auto obj : newProgram->objects) {
+        if (!oldObjects.count(obj))
+            continue;
+        auto it = usedNames.find(obj);
+        if (it == usedNames.end()) {
+            it = usedNames.emplace(obj, std::set<cstring>()).first;
+            obj->apply(UsedNames(it->second)); }
+        bool uses = false;
+        for (auto name : changed)
+            if (it->second.count(name)) {
+                uses = true;
+                break; }
+        if (!uses)
+            unchanged.insert(obj); }
+    if (!newProgram->objects.empty()) {
+        skipped += unchanged.size();
+        saved += static_cast<double>(unchanged.size()) / newProgram->objects.size(); }
+}
+
 const IR::Node *PassRepeated::apply_visitor(const IR::Node *program, const char *name) {
     bool done = false;
     unsigned iterations = 0;
     unsigned initial_error_count = ::errorCount();
+    std::set<const IR::Node *> unchanged;
+    // the PerDeclaration passes must not keep a pointer to 'unchanged' after this returns
+    struct clear_worklist {
+        PassRepeated *self;
+        ~clear_worklist() {
+            if (self->worklist) self->setSkippedDeclarations(nullptr);
+            self->usedNames.clear(); }
+    } clear{this};
+    skipped = 0;
+    saved = 0;
     while (!done) {
         LOG5("PassRepeated state is:\n" << dumpToString(program));
         running = true;
+        if (worklist)
+            setSkippedDeclarations(unchanged.empty() ? nullptr : &unchanged);
         auto newprogram = PassManager::apply_visitor(program, name);
         if (program == newprogram || newprogram == nullptr)
             done = true;
@@ -138,8 +229,15 @@ const IR::Node *PassRepeated::apply_visitor(const IR::Node *program, const char
         iterations++;
         if (repeats != 0 && iterations > repeats)
             done = true;
+        if (worklist && !done)
+            updateWorklist(program, newprogram, unchanged);
         program = newprogram;
     }
+    if (worklist) {
+        LOG1(this->name() << " converged after " << iterations << " iterations; skipped " <<
+             skipped << " declarations (" << saved << " iterations saved)");
+        totalSkipped += skipped;
+        totalSaved += saved; }
     return program;
 }
 
@@ -158,3 +256,85 @@ const IR::Node *PassIf::apply_visitor(const IR::Node *program, const char *name)
     }
     return program;
 }
+
+const IR::Node *PerDeclaration::apply_visitor(const IR::Node *root, const char *) {
+    auto program = root->to<IR::P4Program>();
+    if (program == nullptr)
+        return root->apply(*visitor, getChildContext());
+
+    // The objects are visited with the program as their parent context, as
+    // when the visitor descends from the program into its objects.  Here the
+    // program itself is not on the context stack, so ctxt is the program's
+    // parent, which is null when the pass is applied at top level.
+    Visitor::Context context = { getChildContext(), program, program, 0, "objects",
+                                 getChildContext() ? getChildContext()->depth + 1 : 1 };
+    std::vector<const IR::Node *> results(program->objects.size());
+#ifdef MULTITHREAD
+    if (parallel && results.size() > 1)
+        visitConcurrently(program, context, results);
+    else
+#endif  // MULTITHREAD
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto obj = program->objects.at(i);
+        // the visitor may overwrite child_index while it descends, so it is reset each time
+        context.child_index = i;
+        if (skip && skip->count(obj))
+            results[i] = obj;
+        else
+            results[i] = obj->apply(*visitor, &context); }
+
+    IR::Vector<IR::Node> objects;
+    bool changed = false;
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto result = results[i];
+        if (result != program->objects.at(i))
+            changed = true;
+        if (result == nullptr)
+            continue;
+        if (auto vec = result->to<IR::Vector<IR::Node>>())
+            objects.append(*vec);
+        else
+            objects.push_back(result);
+    }
+    if (!changed)
+        return program;
+    auto result = program->clone();
+    result->objects = std::move(objects);
+    return result;
+}
+
+#ifdef MULTITHREAD
+void PerDeclaration::visitConcurrently(const IR::P4Program *program, const Context &context,
+                                       std::vector<const IR::Node *> &results) {
+    size_t threads = std::min<size_t>(std::thread::hardware_concurrency(), results.size());
+    if (threads == 0) threads = 1;
+    std::atomic<size_t> next(0);
+    std::vector<std::exception_ptr> errors(threads);
+    // Each thread takes the next unvisited object until none are left; the
+    // calling thread is thread 0.  The first error stops all of them, and is
+    // rethrown once they are done.
+    auto work = [&](size_t thread) {
+        gc_thread_registration gc;
+        try {
+            auto v = visitor->clone();
+            for (size_t i = next++; i < results.size(); i = next++) {
+                auto obj = program->objects.at(i);
+                if (skip && skip->count(obj)) {
+                    results[i] = obj;
+                    continue; }
+                Context objContext = context;
+                objContext.child_index = i;
+                results[i] = obj->apply(*v, &objContext); }
+        } catch (...) {
+            errors[thread] = std::current_exception();
+            next = results.size(); } };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t)
+        workers.emplace_back(work, t);
+    work(0);
+    for (auto &t : workers)
+        t.join();
+    for (auto &e : errors)
+        if (e) std::rethrow_exception(e);
+}
+#endif  // MULTITHREAD
@@ -17,6 +17,9 @@ limitations under the License.
 #ifndef _IR_PASS_MANAGER_H_
 #define _IR_PASS_MANAGER_H_
 
+#include <map>
+#include <set>
+
 #include "visitor.h"
 
 typedef std::function<void(const char* manager, unsigned seqNo,
@@ -89,6 +92,9 @@ class PassManager : virtual public Visitor, virtual public Backtrack {
                 if (auto child = dynamic_cast<PassManager *>(pass))
                     child->addDebugHooks(hooks, recursive); }
     void early_exit() { early_exit_flag = true; }
+    // Tells the PerDeclaration passes in this manager (and in nested managers that
+    // do not keep a worklist of their own) which top-level objects they may skip.
+    void setSkippedDeclarations(const std::set<const IR::Node *> *skip);
     PassManager *clone() const override { return new PassManager(*this); }
 };
 
@@ -107,15 +113,37 @@ class OnBacktrack : virtual public Visitor, virtual public Backtrack {
             return false; } }
 };
 
-// Repeat a pass until convergence (or up to a fixed number of repeats)
+// Repeat a pass until convergence (or up to a fixed number of repeats).
+// With a worklist, every repeat but the first applies the PerDeclaration passes
+// only to the top-level declarations that changed in the previous repeat, or
+// that use the name of one that did; the other passes still see the whole
+// program.  This is the same fixpoint, as any change triggers another repeat.
 class PassRepeated : virtual public PassManager {
     unsigned            repeats;  // 0 = until convergence
+    bool                worklist = false;
+    // declaration visits skipped by the last apply, and the fraction of a
+    // repeat that each skip was
+    unsigned            skipped = 0;
+    double              saved = 0;
+    // the same two counters, summed over every worklist PassRepeated run so far
+    static unsigned     totalSkipped;
+    static double       totalSaved;
+    // names used by each top-level object, computed once per object
+    std::map<const IR::Node *, std::set<cstring>> usedNames;
+    void updateWorklist(const IR::Node *before, const IR::Node *after,
+                        std::set<const IR::Node *> &unchanged);
  public:
     PassRepeated() : repeats(0) {}
     PassRepeated(const std::initializer_list<VisitorRef> &init) :
             PassManager(init), repeats(0) {}
     const IR::Node *apply_visitor(const IR::Node *, const char * = 0) override;
     PassRepeated *setRepeats(unsigned repeats) { this->repeats = repeats; return this; }
+    PassRepeated *setWorklist(bool worklist = true) { this->worklist = worklist; return this; }
+    bool hasWorklist() const { return worklist; }
+    unsigned skippedDeclarations() const { return skipped; }
+    double iterationsSaved() const { return saved; }
+    static unsigned totalSkippedDeclarations() { return totalSkipped; }
+    static double totalIterationsSaved() { return totalSaved; }
     PassRepeated *clone() const override { return new PassRepeated(*this); }
 };
 
@@ -140,6 +168,38 @@ class PassIf : virtual public PassManager {
     PassIf *clone() const override { return new PassIf(*this); }
 };
 
+// Applies a visitor separately to each top-level object of a P4Program, as if
+// each were the root of its own program, then rebuilds the program's objects
+// in their original order; any other root is visited as a whole.  This is only
+// correct for passes that are local to a declaration: the rewrite of a parser,
+// control, action or function must not depend on other top-level objects
+// (except through read-only ReferenceMap/TypeMap lookups), and the pass must
+// not visit the P4Program node itself.  Each object gets fresh visitor state
+// (a Transform's change tracker only grows to the size of one declaration).
+//
+// With setParallel(), a MULTITHREAD build visits the objects concurrently, on
+// up to one thread per core, each with its own clone() of the visitor.  Only
+// passes that keep no state across declarations and write nothing shared
+// (errors and warnings excepted) may opt in; diagnostics from different
+// declarations may then be reported in any order.  Other builds always visit
+// the objects one at a time.
+class PerDeclaration : virtual public Visitor {
+    Visitor     *visitor;
+    bool        parallel = false;
+    // objects left as they are; set by an enclosing PassRepeated worklist
+    const std::set<const IR::Node *> *skip = nullptr;
+    const IR::Node *apply_visitor(const IR::Node *, const char * = 0) override;
+#ifdef MULTITHREAD
+    void visitConcurrently(const IR::P4Program *program, const Context &context,
+                           std::vector<const IR::Node *> &results);
+#endif  // MULTITHREAD
+ public:
+    explicit PerDeclaration(Visitor *v) : visitor(v) { CHECK_NULL(v); setName(v->name()); }
+    PerDeclaration *setParallel(bool p = true) { parallel = p; return this; }
+    void setSkippedDeclarations(const std::set<const IR::Node *> *skip) { this->skip = skip; }
+    PerDeclaration *clone() const override { return new PerDeclaration(*this); }
+};
+
 // Converts a function Node* -> Node* into a visitor
 class VisitFunctor : virtual public Visitor {
     std::function<const IR::Node *(const IR::Node *)>       fn;
@@ -51,8 +51,8 @@ const cstring IR::Annotation::noSideEffectsAnnotation = "noSideEffects";
 const cstring IR::Annotation::noWarnAnnotation = "noWarn";
 const cstring IR::Annotation::matchAnnotation = "match";
 
-int Type_Declaration::nextId = 0;
-int Type_InfInt::nextId = 0;
+IdCounter Type_Declaration::nextId(0);
+IdCounter Type_InfInt::nextId(0);
 
 Annotations* Annotations::empty = new Annotations(Vector<Annotation>());
 
@@ -162,8 +162,14 @@ Visitor::profile_t Transform::init_apply(const IR::Node *root) {
 void Visitor::end_apply() {}
 void Visitor::end_apply(const IR::Node*) {}
 
+// PerDeclaration may apply visitors on several threads, each with its own nesting
+#ifdef MULTITHREAD
+static thread_local indent_t profile_indent;
+static std::atomic<uint64_t> first_start(0);
+#else
 static indent_t profile_indent;
 static uint64_t first_start = 0;
+#endif  // MULTITHREAD
 Visitor::profile_t::profile_t(Visitor &v_) : v(v_) {
     struct timespec ts;
 #ifdef CLOCK_MONOTONIC
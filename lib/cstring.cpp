@@ -17,172 +17,108 @@ limitations under the License.
 #include "cstring.h"
 
 #include <algorithm>
+#include <new>
 #include <string>
 #include <unordered_set>
+#ifdef MULTITHREAD
+#include <atomic>
+#include <mutex>
+#endif  // MULTITHREAD
 
 #include "hash.h"
 
 namespace {
-enum class table_entry_flags {
-    none,
-    no_need_copy = 1 << 0,
-    require_destruction = 1 << 1,
-    inplace = 1 << 2,
+// cache entry: an interned string, or a string being looked up
+struct table_key {
+    const char *string;
+    std::size_t length;
+    std::size_t hash;
+    // start of the allocation holding the interned string, null for lookups
+    const void *block;
 };
 
-inline table_entry_flags operator &(table_entry_flags l, table_entry_flags r) {
-    return static_cast<table_entry_flags>(static_cast<int>(l) & static_cast<int>(r));
-}
-
-inline table_entry_flags operator |(table_entry_flags l, table_entry_flags r) {
-    return static_cast<table_entry_flags>(static_cast<int>(l) | static_cast<int>(r));
-}
-
-// cache entry, ordered by string length
-class table_entry {
-    std::size_t m_length = 0;
-    table_entry_flags m_flags = table_entry_flags::none;
-
-    union {
-        const char *m_string;
-        char m_inplace_string[sizeof(const char *)];
-    };
-
- public:
-    // entry ctor, makes copy of passed string
-    table_entry(const char *string, std::size_t length, table_entry_flags flags)
-        : m_length(length) {
-        if ((flags & table_entry_flags::no_need_copy) == table_entry_flags::no_need_copy) {
-            // No need to copy object, it's view of string, string literal or string allocated
-            // on heap and wrapped with cstring.
-            // Inherit require_destruction flag here, because string can be allready
-            // allocated on heap and wrapped with cstring object, so cstring owns the string now
-
-            m_flags = flags & table_entry_flags::require_destruction;
-            m_string = string;
-            return;
-        }
-
-        if (length < sizeof(const char *)) {
-            // String with length less than size of pointer store directly
-            // in pointer, that hint allows reduce stack fragmentation.
-            // We can make such optimization because std::unordered_set never
-            // moves objects in memory on new element insert
-            std::memcpy(m_inplace_string, string, length);
-            m_inplace_string[length] = '\0';
-            m_flags = table_entry_flags::inplace;
-        } else {
-            // Make copy of string elseware
-            auto copy = new char[length + 1];
-            std::memcpy(copy, string, length);
-            copy[length] = '\0';
-            m_string = copy;
-
-            // destruction required, because we own copy of string
-            m_flags = table_entry_flags::require_destruction;
-        }
-    }
-
-    // table_entry moveable only
-    table_entry(const table_entry &) = delete;
-
-    table_entry(table_entry &&other) : m_length(other.m_length), m_flags(other.m_flags) {
-        // this object for internal usage only, length will never be accessed
-        // if object was moved, so do not zero other.m_length here
-
-        if (is_inplace()) {
-            std::memcpy(m_inplace_string, other.m_inplace_string, sizeof(m_inplace_string));
-        } else {
-            m_string = other.string();
-            other.m_string = nullptr;
-        }
-    }
-
-    ~table_entry() {
-        if ((m_flags & table_entry_flags::require_destruction) ==
-                table_entry_flags::require_destruction) {
-            // null pointer checked in operator delete [], so we don't need
-            // to check it explicitly
-
-            delete [] m_string;
-        }
-    }
-
-    std::size_t length() const {
-        return m_length;
-    }
-
-    const char *string() const {
-        if (is_inplace()) {
-            return m_inplace_string;
-        }
-
-        return m_string;
-    }
-
-    bool operator ==(const table_entry &other) const {
-        return length() == other.length() && std::memcmp(string(), other.string(), length()) == 0;
-    }
-
- private:
-    bool is_inplace() const {
-        return (m_flags & table_entry_flags::inplace) == table_entry_flags::inplace;
-    }
+struct table_key_hash {
+    std::size_t operator()(const table_key &key) const { return key.hash; }
 };
-}  // namespace
 
-namespace std {
-template<>
-struct hash<table_entry> {
-    std::size_t operator()(const table_entry &entry) const {
-        return Util::Hash::murmur(entry.string(), entry.length());
+struct table_key_equal {
+    bool operator()(const table_key &l, const table_key &r) const {
+        return l.length == r.length && std::memcmp(l.string, r.string, l.length) == 0;
     }
 };
-}
 
-namespace {
-std::unordered_set<table_entry>& cache() {
-    static std::unordered_set<table_entry> g_cache;
+std::unordered_set<table_key, table_key_hash, table_key_equal>& cache() {
+    static std::unordered_set<table_key, table_key_hash, table_key_equal> g_cache;
 
     return g_cache;
 }
 
-const char *save_to_cache(const char *string, std::size_t length, table_entry_flags flags) {
-    if ((flags & table_entry_flags::no_need_copy) == table_entry_flags::no_need_copy) {
-        return cache().emplace(string, length, flags).first->string();
-    }
-
-    // temporary table_entry, used for searching only. no need to copy string
-    auto found = cache().find(table_entry(string, length, table_entry_flags::no_need_copy));
-
-    if (found == cache().end()) {
-        return cache().emplace(string, length, flags).first->string();
-    }
+#ifdef MULTITHREAD
+// guards cache(); interning is rare enough next to cstring use that one lock will do
+std::mutex cache_lock;
+#define LOCK_CACHE      std::lock_guard<std::mutex> acquire(cache_lock)
+// read by cache_size() without the lock, as the GC callback may run while another
+// (stopped) thread holds it
+std::atomic<size_t> cache_count, cache_bytes;
+#else
+#define LOCK_CACHE
+size_t cache_count, cache_bytes;
+#endif  // MULTITHREAD
+}  // namespace
 
-    return found->string();
+const char *cstring::save_to_cache(const char *string, std::size_t length) {
+    table_key key = { string, length, Util::Hash::murmur(string, length), nullptr };
+    LOCK_CACHE;
+    auto found = cache().find(key);
+    if (found != cache().end())
+        return found->string;
+
+    // Every interned string is copied after its table_info, so that the id,
+    // length and hash of a cstring can be read without looking it up.
+    auto block = new char[sizeof(table_info) + length + 1];
+    auto copy = block + sizeof(table_info);
+    std::memcpy(copy, string, length);
+    copy[length] = '\0';
+    auto info = new(block) table_info;
+    info->hash = key.hash;
+    // size() is the length up to the first null, as for any C string
+    info->length = std::find(copy, copy + length, '\0') - copy;
+    info->id = ++cache_count;
+    cache_bytes += sizeof(key) + sizeof(table_info) + length + 1;
+    key.string = copy;
+    key.block = block;
+    cache().insert(key);
+    return copy;
+}
+
+cstring cstring::get_interned(const char *string, std::size_t length) {
+    cstring rv;
+    if (string == nullptr)
+        return rv;
+    table_key key = { string, length, Util::Hash::murmur(string, length), nullptr };
+    LOCK_CACHE;
+    auto found = cache().find(key);
+    if (found != cache().end())
+        rv.str = found->string;
+    return rv;
 }
 
-}  // namespace
-
 void cstring::construct_from_shared(const char *string, std::size_t length) {
-    str = save_to_cache(string, length, table_entry_flags::none);
+    str = save_to_cache(string, length);
 }
 
 void cstring::construct_from_unique(const char *string, std::size_t length) {
-    str = save_to_cache(string, length,
-        table_entry_flags::no_need_copy | table_entry_flags::require_destruction);
+    str = save_to_cache(string, length);
+    delete [] string;
 }
 
 void cstring::construct_from_literal(const char *string, std::size_t length) {
-    str = save_to_cache(string, length, table_entry_flags::no_need_copy);
+    str = save_to_cache(string, length);
 }
 
 size_t cstring::cache_size(size_t &count) {
-    size_t rv = 0;
-    count = cache().size();
-    for (auto &s : cache())
-        rv += sizeof(s) + s.length();
-    return rv;
+    count = cache_count;
+    return cache_bytes;
 }
 
 cstring cstring::newline = cstring("\n");
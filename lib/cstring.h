@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <cstring>
 #include <cstddef>
+#include <cstdint>
 
 #include <functional>
 #include <iostream>
@@ -51,8 +52,12 @@ limitations under the License.
  *     std::string.
  *   - Interned strings can never be freed, so they'll stick around for the
  *     lifetime of the program.
- *   - The string interning cstring performs is currently not threadsafe, so you
+ *   - The string interning cstring performs is only threadsafe when built with
+ *     MULTITHREAD, which guards the intern table with a mutex; otherwise you
  *     can't safely use cstrings off the main thread.
+ *   - Ordering cstrings (operator<) compares their characters.  Containers that
+ *     do not need lexical order can use cstring::id_less, which compares the
+ *     intern ids in constant time.
  *
  * Given these tradeoffs, the general rule of thumb to follow is that you should
  * try to convert strings to cstrings early and keep them in that form. That
@@ -136,6 +141,18 @@ class cstring {
     }
 
  private:
+    // Header stored by the intern table just before the characters of every
+    // interned string.
+    struct table_info {
+        std::size_t hash;
+        std::size_t length;
+        uint32_t id;
+    };
+    const table_info *info() const { return reinterpret_cast<const table_info *>(str) - 1; }
+
+    // @return the interned copy of the string
+    static const char *save_to_cache(const char *string, std::size_t length);
+
     // passed string is shared, we not unique owners
     void construct_from_shared(const char *string, std::size_t length);
 
@@ -159,19 +176,28 @@ class cstring {
     const char *c_str() const { return str; }
     operator const char *() const { return str; }
 
-    // Size tests. Constant time except for size(), which is linear time.
-    size_t size() const {
-        // TODO (DanilLutsenko): We store size of string in table on object construction,
-        // compiler cannot optimize strlen if str not points to string literal.
-        // Probably better fetch size from table or store it to cstring on construction.
-        return str ? strlen(str) : 0;
-    }
+    // Size tests. Constant time.
+    size_t size() const { return str ? info()->length : 0; }
     bool isNull() const { return str == nullptr; }
     bool isNullOrEmpty() const { return str == nullptr ? true : str[0] == 0; }
 
+    /// A number identifying the interned string, or 0 for a null cstring.  Ids are
+    /// assigned in the order strings are first interned, so they are not in lexical
+    /// order and may differ between runs; don't let them decide output order.
+    uint32_t id() const { return str ? info()->id : 0; }
+    /// A hash of the characters of the string, computed once when it is interned.
+    /// Unlike the address of the string, it is the same in every run.
+    size_t hash() const { return str ? info()->hash : 0; }
+
+    /// Orders cstrings by id in constant time, for containers that need an order but
+    /// not the lexical one.
+    struct id_less {
+        bool operator()(cstring a, cstring b) const { return a.id() < b.id(); }
+    };
+
     // iterate over characters
     const char *begin() const { return str; }
-    const char *end() const { return str ? str + strlen(str) : str; }
+    const char *end() const { return str ? str + size() : str; }
 
     // Search for characters. Linear time.
     const char *find(int c) const { return str ? strchr(str, c) : nullptr; }
@@ -254,6 +280,12 @@ class cstring {
         return cstring(ss.str()); }
     template<class T> static cstring make_unique(const T &inuse, cstring base, char sep = '.');
 
+    /// @return the interned string equal to @string, or a null cstring if there is
+    /// none.  Unlike the constructors, this never adds the string to the table.
+    static cstring get_interned(const char *string, std::size_t length);
+    static cstring get_interned(const std::string &string) {
+        return get_interned(string.data(), string.length()); }
+
     /// @return the total size in bytes of all interned strings. @count is set
     /// to the total number of interned strings.
     static size_t cache_size(size_t &count);
@@ -303,8 +335,10 @@ inline std::ostream &operator<<(std::ostream &out, cstring s) {
 namespace std {
 template<> struct hash<cstring> {
     std::size_t operator()(const cstring& c) const {
-        // This implementation is good for cstring, since the strings are internalized
-        return hash<const void *>()(c.c_str());
+        // The hash is cached in the intern table.  Unlike the address of the
+        // string, it does not depend on the allocator, so unordered containers
+        // are iterated in the same order in every run.
+        return c.hash();
     }
 };
 }  // namespace std
@@ -17,6 +17,10 @@ limitations under the License.
 #ifndef _LIB_ERROR_REPORTER_H_
 #define _LIB_ERROR_REPORTER_H_
 
+#ifdef MULTITHREAD
+#include <mutex>
+#endif  // MULTITHREAD
+
 #include "error_helper.h"
 #include "error_catalog.h"
 #include "exceptions.h"
@@ -41,6 +45,14 @@ class ErrorReporter {
     /// Track errors or warnings that have already been issued for a particular source location
     std::set<std::pair<int, const Util::SourceInfo>> errorTracker;
 
+#ifdef MULTITHREAD
+    /// Serializes diagnostics from passes that visit declarations on several threads
+    /// (see PerDeclaration).  A single lock, as reporters are copied with their context.
+    static std::mutex &diagnosticLock() {
+        static std::mutex lock;
+        return lock; }
+#endif  // MULTITHREAD
+
     /// Output the message and flush the stream
     virtual void emit_message(const ErrorMessage &msg) {
         *outputstream << msg.toString();
@@ -57,6 +69,9 @@ class ErrorReporter {
     /// If the error has been reported, return true. Otherwise, insert add the error to the
     /// list of seen errors, and return false.
     bool error_reported(int err, const Util::SourceInfo source) {
+#ifdef MULTITHREAD
+        std::lock_guard<std::mutex> guard(diagnosticLock());
+#endif  // MULTITHREAD
         auto p = errorTracker.emplace(err, source);
         return !p.second;  // if insertion took place, then we have not seen the error.
     }
@@ -131,6 +146,9 @@ class ErrorReporter {
     void diagnose(DiagnosticAction action, const char* diagnosticName,
                   const char* format, const char* suffix, T... args) {
         if (action == DiagnosticAction::Ignore) return;
+#ifdef MULTITHREAD
+        std::lock_guard<std::mutex> guard(diagnosticLock());
+#endif  // MULTITHREAD
 
         ErrorMessage::MessageType msgType = ErrorMessage::MessageType::None;
         if (action == DiagnosticAction::Warn) {
@@ -16,11 +16,19 @@ limitations under the License.
 
 #include "config.h"
 #if HAVE_LIBGC
+#ifdef MULTITHREAD
+// thread-aware collector entry points; GC_malloc then allocates small objects
+// from per-thread free lists, and marking runs on GC_MARKERS threads
+#define GC_THREADS
+#endif  // MULTITHREAD
 #include <gc/gc_cpp.h>
 #include <gc/gc_mark.h>
 #endif  /* HAVE_LIBGC */
 #include <unistd.h>
 #include <new>
+#ifdef MULTITHREAD
+#include <mutex>
+#endif  // MULTITHREAD
 #include "log.h"
 #include "gc.h"
 #include "cstring.h"
@@ -41,23 +49,37 @@ static char *emergency_ptr;
 
 // One can disable the GC, e.g., to run under Valgrind, by editing config.h
 #if HAVE_LIBGC
+static void init_gc() {
+    started_init = true;
+    GC_INIT();
+#ifdef MULTITHREAD
+    // the initializing (main) thread is registered implicitly; others register
+    // themselves with gc_thread_registration
+    GC_allow_register_threads();
+#endif  // MULTITHREAD
+    done_init = true;
+}
+
 void *operator new(std::size_t size) {
     /* DANGER -- on OSX, can't safely call the garbage collector allocation
      * routines from a static global constructor without manually initializing
      * it first.  Since we have global constructors that want to allocate
      * memory, we need to force initialization */
-    if (!done_init) {
-        started_init = true;
-        GC_INIT();
-        done_init = true; }
+    if (!done_init)
+        init_gc();
     auto *rv = ::operator new(size, UseGC, 0, 0);
-    if (!rv && emergency_ptr && emergency_ptr + size < emergency_pool + sizeof(emergency_pool)) {
-        rv = emergency_ptr;
-        size += -size & 0xf;  // align to 16 bytes
-        emergency_ptr += size; }
     if (!rv) {
-        if (!emergency_ptr) emergency_ptr = emergency_pool;
-        throw backtrace_exception<std::bad_alloc>(); }
+#ifdef MULTITHREAD
+        static std::mutex lock;
+        std::lock_guard<std::mutex> acquire(lock);
+#endif  // MULTITHREAD
+        if (emergency_ptr && emergency_ptr + size < emergency_pool + sizeof(emergency_pool)) {
+            rv = emergency_ptr;
+            size += -size & 0xf;  // align to 16 bytes
+            emergency_ptr += size; }
+        if (!rv) {
+            if (!emergency_ptr) emergency_ptr = emergency_pool;
+            throw backtrace_exception<std::bad_alloc>(); } }
     return rv;
 }
 void operator delete(void *p) _GLIBCXX_USE_NOEXCEPT {
@@ -81,9 +103,7 @@ void *realloc(void *ptr, size_t size) {
                 memcpy(rv, ptr, max < size ? max : size); }
             return rv;
         } else {
-            started_init = true;
-            GC_INIT();
-            done_init = true; } }
+            init_gc(); } }
     if (ptr) {
         if (GC_is_heap_ptr(ptr))
             return GC_realloc(ptr, size);
@@ -155,3 +175,31 @@ size_t gc_mem_inuse(size_t *max) {
     return 0;
 #endif
 }
+
+#ifdef MULTITHREAD
+gc_thread_registration::gc_thread_registration() {
+#if HAVE_LIBGC
+    if (!done_init)
+        init_gc();
+    struct GC_stack_base base;
+    // GC_DUPLICATE for a thread the collector already knows, e.g. the main one
+    registered = GC_get_stack_base(&base) == GC_SUCCESS &&
+                 GC_register_my_thread(&base) == GC_SUCCESS;
+#endif  /* HAVE_LIBGC */
+}
+
+gc_thread_registration::~gc_thread_registration() {
+#if HAVE_LIBGC
+    if (registered)
+        GC_unregister_my_thread();
+#endif  /* HAVE_LIBGC */
+}
+#endif  // MULTITHREAD
+
+size_t gc_heap_size() {
+#if HAVE_LIBGC
+    return GC_get_heap_size();
+#else
+    return 0;
+#endif
+}
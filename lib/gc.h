@@ -21,5 +21,23 @@ limitations under the License.
 
 void setup_gc_logging();
 size_t gc_mem_inuse(size_t *max = 0);  // trigger GC, return inuse after
+size_t gc_heap_size();  // current heap size, without triggering GC
+
+#ifdef MULTITHREAD
+/* Registers the current thread with the collector for the lifetime of the object, so
+ * that it may allocate GC memory and its stack is scanned for roots.  Every thread other
+ * than the main one must hold one while it creates or references IR or cstrings:
+ *     std::thread([] { gc_thread_registration gc; ... });
+ * Objects are allocated from per-thread free lists, and the mark phase uses GC_MARKERS
+ * threads (by default, one per core). */
+class gc_thread_registration {
+    bool registered = false;
+ public:
+    gc_thread_registration();
+    ~gc_thread_registration();
+    gc_thread_registration(const gc_thread_registration &) = delete;
+    gc_thread_registration &operator=(const gc_thread_registration &) = delete;
+};
+#endif  // MULTITHREAD
 
 #endif /* LIB_GC_H_ */
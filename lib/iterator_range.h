@@ -0,0 +1,156 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _LIB_ITERATOR_RANGE_H_
+#define _LIB_ITERATOR_RANGE_H_
+
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* A value type alternative to Util::Enumerator.  An iterator_range is a pair
+   of iterators; where, map, as and concat return new ranges whose iterators
+   wrap the ones of this range, so a chain of them is composed at compile time
+   and does not allocate.  Ranges are lazy: the filters and functions run as
+   the range is iterated, once per element and iteration.
+
+   The iterators only support what range-based for loops need, and they do
+   not own the underlying collection, which must outlive the range. */
+
+namespace Util {
+
+template <class Iter, class Pred>
+class filter_iterator {
+    Iter        cur, fin;
+    Pred        pred;
+
+    void skip() { while (cur != fin && !pred(*cur)) ++cur; }
+
+ public:
+    typedef decltype(*std::declval<Iter>())             reference;
+    typedef typename std::decay<reference>::type        value_type;
+
+    filter_iterator(Iter cur, Iter fin, Pred pred) : cur(cur), fin(fin), pred(pred) { skip(); }
+    reference operator*() const { return *cur; }
+    filter_iterator &operator++() { ++cur; skip(); return *this; }
+    bool operator==(const filter_iterator &i) const { return cur == i.cur; }
+    bool operator!=(const filter_iterator &i) const { return cur != i.cur; }
+};
+
+template <class Iter, class Fn>
+class map_iterator {
+    Iter        cur;
+    Fn          fn;
+
+ public:
+    typedef decltype(std::declval<Fn>()(*std::declval<Iter>()))     value_type;
+    typedef value_type                                              reference;
+
+    map_iterator(Iter cur, Fn fn) : cur(cur), fn(fn) {}
+    value_type operator*() const { return fn(*cur); }
+    map_iterator &operator++() { ++cur; return *this; }
+    bool operator==(const map_iterator &i) const { return cur == i.cur; }
+    bool operator!=(const map_iterator &i) const { return cur != i.cur; }
+};
+
+template <class Iter1, class Iter2>
+class concat_iterator {
+    Iter1       cur1, fin1;
+    Iter2       cur2;
+
+ public:
+    typedef typename std::common_type<
+        typename std::decay<decltype(*std::declval<Iter1>())>::type,
+        typename std::decay<decltype(*std::declval<Iter2>())>::type>::type value_type;
+    typedef value_type                                                      reference;
+
+    concat_iterator(Iter1 cur1, Iter1 fin1, Iter2 cur2) : cur1(cur1), fin1(fin1), cur2(cur2) {}
+    value_type operator*() const { return cur1 != fin1 ? *cur1 : *cur2; }
+    concat_iterator &operator++() {
+        if (cur1 != fin1)
+            ++cur1;
+        else
+            ++cur2;
+        return *this; }
+    bool operator==(const concat_iterator &i) const { return cur1 == i.cur1 && cur2 == i.cur2; }
+    bool operator!=(const concat_iterator &i) const { return !(*this == i); }
+};
+
+/* Casts pointers like Enumerator::as(), producing null if the cast fails */
+template <class T>
+struct dynamic_cast_to {
+    template <class U> T operator()(U u) const { return dynamic_cast<T>(u); }
+};
+
+template <class Iter>
+class iterator_range {
+    Iter        b, e;
+
+ public:
+    typedef typename std::decay<decltype(*std::declval<Iter>())>::type    value_type;
+
+    iterator_range(Iter b, Iter e) : b(b), e(e) {}
+    Iter begin() const { return b; }
+    Iter end() const { return e; }
+    bool empty() const { return !(b != e); }
+
+    /* the elements for which pred is true */
+    template <class Pred>
+    iterator_range<filter_iterator<Iter, Pred>> where(Pred pred) const {
+        return iterator_range<filter_iterator<Iter, Pred>>(
+            filter_iterator<Iter, Pred>(b, e, pred), filter_iterator<Iter, Pred>(e, e, pred)); }
+    /* fn applied to every element */
+    template <class Fn>
+    iterator_range<map_iterator<Iter, Fn>> map(Fn fn) const {
+        return iterator_range<map_iterator<Iter, Fn>>(
+            map_iterator<Iter, Fn>(b, fn), map_iterator<Iter, Fn>(e, fn)); }
+    /* every element cast to T */
+    template <class T>
+    iterator_range<map_iterator<Iter, dynamic_cast_to<T>>> as() const {
+        return map(dynamic_cast_to<T>()); }
+    /* the elements of this range followed by those of other */
+    template <class Iter2>
+    iterator_range<concat_iterator<Iter, Iter2>> concat(const iterator_range<Iter2> &other) const {
+        return iterator_range<concat_iterator<Iter, Iter2>>(
+            concat_iterator<Iter, Iter2>(b, e, other.begin()),
+            concat_iterator<Iter, Iter2>(e, e, other.end())); }
+
+    std::vector<value_type> toVector() const {
+        std::vector<value_type> rv;
+        for (auto it = b; it != e; ++it)
+            rv.push_back(*it);
+        return rv; }
+    uint64_t count() const {
+        uint64_t rv = 0;
+        for (auto it = b; it != e; ++it)
+            ++rv;
+        return rv; }
+    bool any() const { return !empty(); }
+    /* the first element, or the default value if the range is empty */
+    value_type nextOrDefault() const { return empty() ? value_type() : *b; }
+};
+
+template <class Iter>
+iterator_range<Iter> make_range(Iter b, Iter e) { return iterator_range<Iter>(b, e); }
+
+template <class Container>
+auto make_range(const Container &c) -> iterator_range<decltype(c.begin())> {
+    return iterator_range<decltype(c.begin())>(c.begin(), c.end()); }
+
+}  // namespace Util
+
+#endif /* _LIB_ITERATOR_RANGE_H_ */
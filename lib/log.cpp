@@ -41,6 +41,11 @@ namespace Detail {
 
 int verbosity = 0;
 int maximumLogLevel = 0;
+#ifdef MULTITHREAD
+std::atomic<int> cacheEpoch(0);
+#else
+int cacheEpoch = 0;
+#endif  // MULTITHREAD
 
 // The time at which logging was initialized; used so that log messages can have
 // relative rather than absolute timestamps.
@@ -272,6 +277,7 @@ void invalidateCaches(int possibleNewMaxLogLevel) {
     mostRecentInfo = nullptr;
     logLevelCache.clear();
     maximumLogLevel = std::max(maximumLogLevel, possibleNewMaxLogLevel);
+    cacheEpoch++;
     for (auto fn : invalidateCallbacks) fn();
 }
 
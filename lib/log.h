@@ -19,6 +19,9 @@ limitations under the License.
 
 #include <functional>
 #include <iostream>
+#ifdef MULTITHREAD
+#include <atomic>
+#endif  // MULTITHREAD
 #include <set>
 #include <vector>
 #include "indent.h"
@@ -37,6 +40,26 @@ extern int verbosity;
 // A cache of the maximum log level requested for any file.
 extern int maximumLogLevel;
 
+// Incremented whenever the log levels may have changed.
+#ifdef MULTITHREAD
+extern std::atomic<int> cacheEpoch;
+#else
+extern int cacheEpoch;
+#endif  // MULTITHREAD
+
+// The log level of a LOG call site, valid as long as @epoch is cacheEpoch.
+// Threads may race to fill it in; they all store the same level, so relaxed
+// accesses are enough.
+struct CallSiteLevel {
+#ifdef MULTITHREAD
+    std::atomic<int> epoch{-1};
+    std::atomic<int> level{0};
+#else
+    int epoch = -1;
+    int level = 0;
+#endif  // MULTITHREAD
+};
+
 // Look up the log level of @file.
 int fileLogLevel(const char* file);
 std::ostream &fileLogOutput(const char *file);
@@ -77,6 +100,33 @@ inline bool fileLogLevelIsAtLeast(const char* file, int level) {
     return Detail::fileLogLevel(file) >= level;
 }
 
+// Same as above, but caches the log level of @file in @site, so that a call
+// site in a hot loop does not look up its file every time it is reached.
+inline bool fileLogLevelIsAtLeast(const char* file, int level, Detail::CallSiteLevel &site) {
+    if (Detail::maximumLogLevel < level) {
+        return false;
+    }
+
+#ifdef MULTITHREAD
+    // The epoch is read before the level is looked up, so that an
+    // invalidation in between makes the next call look it up again.
+    int epoch = Detail::cacheEpoch.load(std::memory_order_relaxed);
+    if (site.epoch.load(std::memory_order_relaxed) != epoch) {
+        int fileLevel = Detail::fileLogLevel(file);
+        site.level.store(fileLevel, std::memory_order_relaxed);
+        site.epoch.store(epoch, std::memory_order_relaxed);
+        return fileLevel >= level;
+    }
+    return site.level.load(std::memory_order_relaxed) >= level;
+#else
+    if (site.epoch != Detail::cacheEpoch) {
+        site.level = Detail::fileLogLevel(file);
+        site.epoch = Detail::cacheEpoch;
+    }
+    return site.level >= level;
+#endif  // MULTITHREAD
+}
+
 // Process @spec and update the log level requested for the appropriate file.
 void addDebugSpec(const char* spec);
 
@@ -91,7 +141,14 @@ void increaseVerbosity();
 #define MAX_LOGGING_LEVEL 10
 #endif
 
-#define LOGGING(N) ((N) <= MAX_LOGGING_LEVEL && ::Log::fileLogLevelIsAtLeast(__FILE__, N))
+// The lambda gives each call site its own static cache of the log level.
+#define LOG_CALL_SITE_LEVEL                                                     \
+    ([]() -> ::Log::Detail::CallSiteLevel & {                                   \
+        static ::Log::Detail::CallSiteLevel site;                               \
+        return site; }())
+
+#define LOGGING(N) ((N) <= MAX_LOGGING_LEVEL &&                                 \
+                    ::Log::fileLogLevelIsAtLeast(__FILE__, N, LOG_CALL_SITE_LEVEL))
 #define LOGN(N, X) (LOGGING(N)                                                  \
                       ? ::Log::Detail::fileLogOutput(__FILE__)                  \
                           << ::Log::Detail::OutputLogPrefix(__FILE__, N)        \
@@ -119,7 +176,8 @@ void increaseVerbosity();
 #define LOG8_UNINDENT   LOGN_UNINDENT(8)
 #define LOG9_UNINDENT   LOGN_UNINDENT(9)
 
-#define LOG_FEATURE(TAG, N, X) ((N) <= MAX_LOGGING_LEVEL && ::Log::fileLogLevelIsAtLeast(TAG, N) \
+#define LOG_FEATURE(TAG, N, X) ((N) <= MAX_LOGGING_LEVEL &&                      \
+                      ::Log::fileLogLevelIsAtLeast(TAG, N, LOG_CALL_SITE_LEVEL) \
                       ? ::Log::Detail::fileLogOutput(TAG)                       \
                           << ::Log::Detail::OutputLogPrefix(TAG, N)             \
                           << X << std::endl                                     \
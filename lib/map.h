@@ -101,6 +101,7 @@ Keys(std::pair<PairIter, PairIter> range) {
 /* iterate over the values in a map */
 template<class PairIter>
 class IterValues {
+ public:
     class iterator : public std::iterator<
         typename std::iterator_traits<PairIter>::iterator_category,
         typename std::iterator_traits<PairIter>::value_type::second_type,
@@ -118,7 +119,10 @@ class IterValues {
         bool operator!=(const iterator &i) const { return it != i.it; }
         decltype(*&it->second) operator*() const { return it->second; }
         decltype(&it->second) operator->() const { return &it->second; }
-    } b, e;
+    };
+
+ private:
+    iterator b, e;
 
  public:
     template<class U> IterValues(U &map) : b(map.begin()), e(map.end()) {}
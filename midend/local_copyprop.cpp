@@ -58,6 +58,24 @@ static cstring expr_name(const IR::Expression *exp) {
     return cstring();
 }
 
+namespace {
+
+/// collect the names of the paths and primitives used in an expression
+class PathNames : public Inspector {
+    std::vector<cstring> &names;
+    bool preorder(const IR::Path *p) override {
+        names.push_back(p->name);
+        return false; }
+    bool preorder(const IR::Primitive *p) override {
+        names.push_back(p->name);
+        return true; }
+
+ public:
+    explicit PathNames(std::vector<cstring> &names) : names(names) {}
+};
+
+}  // namespace
+
 /* LocalCopyPropagation does copy propagation and dead code elimination within a 'block'
  * the body of an action or control (TODO -- extend to parsers/states).  Within the
  * block it tracks all variables defined in the block as well as those defined outside the
@@ -70,14 +88,14 @@ class DoLocalCopyPropagation::ElimDead : public Transform {
      * of the block, so it only removes those vars declared in the block */
     DoLocalCopyPropagation &self;
     const IR::Node *preorder(IR::Declaration_Variable *var) override {
-        if (auto local = ::getref(self.available, var->name)) {
+        if (auto local = self.findVar(var->name)) {
             if (local->local && !local->live) {
                 LOG3("  removing dead local " << var->name);
                 return nullptr; } }
         return var; }
     const IR::Statement *postorder(IR::AssignmentStatement *as) override {
         if (auto dest = lvalue_out(as->left)->to<IR::PathExpression>()) {
-            if (auto var = ::getref(self.available, dest->path->name)) {
+            if (auto var = self.findVar(dest->path->name)) {
                 if (var->local && !var->live) {
                     LOG3("  removing dead assignment to " << dest->path->name);
                     if (self.hasSideEffects(as->right))
@@ -160,66 +178,94 @@ class DoLocalCopyPropagation::RewriteTableKeys : public Transform {
 void DoLocalCopyPropagation::flow_merge(Visitor &a_) {
     auto &a = dynamic_cast<DoLocalCopyPropagation &>(a_);
     BUG_CHECK(working == a.working, "inconsitent DoLocalCopyPropagation state on merge");
-    for (auto &var : available) {
-        if (auto merge = ::getref(a.available, var.first)) {
-            if (merge->val != var.second.val)
-                var.second.val = nullptr;
-            if (merge->live)
-                var.second.live = true;
-        } else {
-            var.second.val = nullptr; } }
+    BUG_CHECK(varIndex == a.varIndex, "inconsitent DoLocalCopyPropagation state on merge");
+    for (int id = 0; id < available.size(); ++id) {
+        auto var = available.get(id);
+        if (!var) continue;
+        auto merge = a.available.get(id);
+        if (var->val && (!merge || merge->val != var->val))
+            available.at(id).val = nullptr;
+        if (merge && merge->live && !var->live)
+            available.at(id).live = true; }
     need_key_rewrite |= a.need_key_rewrite;
 }
 
-/// test to see if names denote overlapping locations
-bool DoLocalCopyPropagation::name_overlap(cstring name1, cstring name2) {
-    if (name1 == name2) return true;
-    if (name1.startsWith(name2) && strchr(".[", name1.get(name2.size())))
-        return true;
-    if (name2.startsWith(name1) && strchr(".[", name2.get(name1.size())))
-        return true;
-    return false;
+int DoLocalCopyPropagation::findVarId(cstring name) const {
+    auto it = varIndex->ids.find(name);
+    return it == varIndex->ids.end() ? -1 : it->second;
+}
+
+DoLocalCopyPropagation::VarInfo &DoLocalCopyPropagation::varInfo(cstring name) {
+    auto it = varIndex->ids.find(name);
+    if (it == varIndex->ids.end()) {
+        it = varIndex->ids.emplace(name, varIndex->names.size()).first;
+        varIndex->names.push_back(name); }
+    return available.at(it->second);
+}
+
+void DoLocalCopyPropagation::setValue(cstring name, const IR::Expression *val) {
+    varInfo(name).val = val;
+    int id = findVarId(name);
+    std::vector<cstring> uses;
+    val->apply(PathNames(uses));
+    for (auto use : uses) {
+        auto &users = varIndex->users[use];
+        if (users.empty() || users.back() != id)
+            users.push_back(id); }
+}
+
+void DoLocalCopyPropagation::clearAvailable() {
+    available.clear();
+    // clones still referring to the old index keep using it consistently
+    varIndex = new VarIndex;
 }
 
 void DoLocalCopyPropagation::forOverlapAvail(cstring name,
                                              std::function<void(cstring, VarInfo *)> fn) {
+    auto &ids = varIndex->ids;
     for (const char *pfx = name.c_str(); *pfx; pfx += strspn(pfx, ".[")) {
         pfx += strcspn(pfx, ".[");
-        auto it = available.find(name.before(pfx));
-        if (it != available.end())
-            fn(it->first, &it->second); }
-    for (auto it = available.upper_bound(name); it != available.end(); ++it) {
+        auto it = ids.find(name.before(pfx));
+        if (it != ids.end() && available.get(it->second))
+            fn(it->first, &available.at(it->second)); }
+    for (auto it = ids.upper_bound(name); it != ids.end(); ++it) {
         if (!it->first.startsWith(name) || !strchr(".[", it->first.get(name.size())))
             break;
-        fn(it->first, &it->second); }
+        if (available.get(it->second))
+            fn(it->first, &available.at(it->second)); }
 }
 
 void DoLocalCopyPropagation::dropValuesUsing(cstring name) {
     LOG6("dropValuesUsing(" << name << ")");
-    for (auto &var : available) {
-        LOG7("  checking " << var.first << " = " << var.second.val);
-        if (name_overlap(var.first, name)) {
-            LOG4("   dropping " << (var.second.val ? "" : "(nop) ") << "as " << name <<
-                 " is being assigned to");
-            var.second.val = nullptr;
-        } else if (var.second.val && exprUses(var.second.val, name)) {
-            LOG4("   dropping " << (var.second.val ? "" : "(nop) ") << var.first <<
-                 " as it uses " << name);
-            var.second.val = nullptr; } }
+    forOverlapAvail(name, [name](cstring vname, VarInfo *var) {
+        LOG4("   dropping " << (var->val ? "" : "(nop) ") << vname << " as " << name <<
+             " is being assigned to");
+        var->val = nullptr; });
+    // Only a value using a path that is a prefix of name (or name itself) can use name
+    for (const char *pfx = name.c_str(); *pfx; pfx += strspn(pfx, ".[")) {
+        pfx += strcspn(pfx, ".[");
+        auto users = varIndex->users.find(name.before(pfx));
+        if (users == varIndex->users.end()) continue;
+        for (auto id : users->second) {
+            auto var = available.get(id);
+            if (!var || !var->val) continue;
+            LOG7("  checking " << varIndex->names[id] << " = " << var->val);
+            if (exprUses(var->val, name)) {
+                LOG4("   dropping " << varIndex->names[id] << " as it uses " << name);
+                available.at(id).val = nullptr; } } }
 }
 
 void DoLocalCopyPropagation::visit_local_decl(const IR::Declaration_Variable *var) {
     LOG4("Visiting " << var);
-    if (available.count(var->name))
+    if (findVar(var->name))
         BUG("duplicate var declaration for %s", var->name);
-    auto &local = available[var->name];
-    local.local = true;
+    varInfo(var->name).local = true;
     if (var->initializer) {
         if (!hasSideEffects(var->initializer)) {
             LOG3("  saving init value for " << var->name << ": " << var->initializer);
-            local.val = var->initializer;
+            setValue(var->name, var->initializer);
         } else {
-            local.live = true; } }
+            varInfo(var->name).live = true; } }
 }
 
 const IR::Node *DoLocalCopyPropagation::postorder(IR::Declaration_Variable *var) {
@@ -258,7 +304,7 @@ const IR::Expression *DoLocalCopyPropagation::copyprop_name(cstring name) {
             if (inferForFunc)
                 inferForFunc->reads.insert(name); }
         return nullptr; }
-    if (auto var = ::getref(available, name)) {
+    if (auto var = findVar(name)) {
         if (var->val) {
             if (policy(getChildContext(), var->val)) {
                 LOG3("  propagating value for " << name << ": " << var->val);
@@ -266,7 +312,7 @@ const IR::Expression *DoLocalCopyPropagation::copyprop_name(cstring name) {
             LOG3("  policy rejects propagation of " << name << ": " << var->val);
         } else {
             LOG4("  using " << name << " with no propagated value"); }
-        var->live = true; }
+        varInfo(name).live = true; }
     forOverlapAvail(name, [name](cstring, VarInfo *var) {
         LOG4("  using part of " << name);
         var->live = true; });
@@ -340,7 +386,7 @@ IR::AssignmentStatement *DoLocalCopyPropagation::postorder(IR::AssignmentStateme
                  * may make things worse rather than better */
                 return as; }
             LOG3("  saving value for " << dest << ": " << as->right);
-            available[dest].val = as->right;
+            setValue(dest, as->right);
         } else {
             LOG3("Can't copyprop " << as->right << " due to side effects"); }
     } else {
@@ -452,14 +498,17 @@ IR::MethodCallExpression *DoLocalCopyPropagation::postorder(IR::MethodCallExpres
             // maybe should have annotations if it does
             return mc; } }
     LOG3("unknown method call " << mc->method << " clears all nonlocal saved values");
-    for (auto &var : available) {
-        if (!var.second.local) {
-            LOG7("    may access non-local " << var.first);
-            var.second.val = nullptr;
-            var.second.live = true;
+    for (int id = 0; id < available.size(); ++id) {
+        auto var = available.get(id);
+        if (var && !var->local) {
+            auto name = varIndex->names[id];
+            LOG7("    may access non-local " << name);
+            auto &info = available.at(id);
+            info.val = nullptr;
+            info.live = true;
             if (inferForFunc) {
-                inferForFunc->reads.insert(var.first);
-                inferForFunc->writes.insert(var.first); } } }
+                inferForFunc->reads.insert(name);
+                inferForFunc->writes.insert(name); } } }
     return mc;
 }
 
@@ -479,7 +528,7 @@ IR::P4Action *DoLocalCopyPropagation::postorder(IR::P4Action *act) {
     BUG_CHECK(inferForFunc == &actions[act->name], "corrupt internal data struct");
     act->body = act->body->apply(ElimDead(*this))->to<IR::BlockStatement>();
     working = false;
-    available.clear();
+    clearAvailable();
     LOG3("DoLocalCopyPropagation finished action " << act->name);
     LOG4("reads=" << inferForFunc->reads << " writes=" << inferForFunc->writes);
     LOG4(act);
@@ -515,7 +564,7 @@ IR::Function *DoLocalCopyPropagation::postorder(IR::Function *fn) {
     BUG_CHECK(inferForFunc == &methods[name], "corrupt internal data struct");
     fn->body = fn->body->apply(ElimDead(*this))->to<IR::BlockStatement>();
     working = false;
-    available.clear();
+    clearAvailable();
     LOG3("DoLocalCopyPropagation finished function " << name);
     LOG4("reads=" << inferForFunc->reads << " writes=" << inferForFunc->writes);
     LOG4(fn);
@@ -557,7 +606,7 @@ IR::P4Control *DoLocalCopyPropagation::preorder(IR::P4Control *ctrl) {
     ctrl->controlLocals = *ctrl->controlLocals.apply(ElimDead(*this));
     ctrl->body = ctrl->body->apply(ElimDead(*this))->to<IR::BlockStatement>();
     working = false;
-    available.clear();
+    clearAvailable();
     LOG3("DoLocalCopyPropagation finished control " << ctrl->name);
     LOG4(ctrl);
     prune();
@@ -631,7 +680,7 @@ const IR::P4Parser *DoLocalCopyPropagation::postorder(IR::P4Parser *parser) {
         apply_function(&states[state->name]);
     auto *rv = parser->apply(ElimDead(*this));
     working = false;
-    available.clear();
+    clearAvailable();
     return rv;
 }
 
@@ -652,7 +701,7 @@ IR::ParserState *DoLocalCopyPropagation::postorder(IR::ParserState *state) {
     state->components = *state->components.apply(ElimDead(*this));
     working = false;
     inferForFunc = nullptr;
-    available.clear();
+    clearAvailable();
     LOG3("DoLocalCopyPropagation finished parser state " << state->name);
     LOG4(state);
     return state;
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef MIDEND_LOCAL_COPYPROP_H_
 #define MIDEND_LOCAL_COPYPROP_H_
 
+#include <unordered_map>
 #include "ir/ir.h"
 #include "frontends/p4/typeChecking/typeChecker.h"
 #include "frontends/common/resolveReferences/referenceMap.h"
@@ -54,10 +55,47 @@ class DoLocalCopyPropagation : public ControlFlowVisitor, Transform, P4WriteCont
     TypeMap                     *typeMap;
     bool                        working = false;
     struct VarInfo {
+        bool                    avail = false;
         bool                    local = false;
         bool                    live = false;
         const IR::Expression    *val = nullptr;
     };
+    /// Dense numbering of the variables tracked in the current block.  It is shared by
+    /// all the clones of the visitor, so a variable has the same index in every branch.
+    struct VarIndex {
+        std::map<cstring, int>                          ids;
+        std::vector<cstring>                            names;
+        /// The variables whose value may use each name.  Entries are not removed when
+        /// a value changes, so they still have to be checked with exprUses.
+        std::unordered_map<cstring, std::vector<int>>   users;
+    };
+    /// The VarInfo of each variable by index.  Clones share the vector until one of them
+    /// modifies it, so a branch only copies the state if it changes it.
+    class AvailVars {
+        std::vector<VarInfo>    *vars;
+        mutable bool            shared = false;
+
+     public:
+        AvailVars() : vars(new std::vector<VarInfo>) {}
+        AvailVars(const AvailVars &a) : vars(a.vars), shared(true) { a.shared = true; }
+        AvailVars &operator=(const AvailVars &) = delete;
+        int size() const { return vars->size(); }
+        bool empty() const { return vars->empty(); }
+        const VarInfo *get(int id) const {
+            if (id < 0 || id >= size() || !(*vars)[id].avail) return nullptr;
+            return &(*vars)[id]; }
+        /// The VarInfo of variable @id for writing, adding it if it is not available.
+        VarInfo &at(int id) {
+            if (shared) {
+                vars = new std::vector<VarInfo>(*vars);
+                shared = false; }
+            if (id >= size()) vars->resize(id + 1);
+            (*vars)[id].avail = true;
+            return (*vars)[id]; }
+        void clear() {
+            vars = new std::vector<VarInfo>;
+            shared = false; }
+    };
     struct TableInfo {
         std::set<cstring>       keyreads, actions;
         int                                             apply_count = 0;
@@ -67,11 +105,15 @@ class DoLocalCopyPropagation : public ControlFlowVisitor, Transform, P4WriteCont
         std::set<cstring>       reads, writes;
         int                     apply_count = 0;
     };
-    std::map<cstring, VarInfo>          available;
-    std::map<cstring, TableInfo>        &tables;
-    std::map<cstring, FuncInfo>         &actions;
-    std::map<cstring, FuncInfo>         &methods;
-    std::map<cstring, FuncInfo>         &states;
+    VarIndex                            *varIndex;
+    AvailVars                           available;
+    // only looked up by name, never iterated
+    typedef std::map<cstring, TableInfo, cstring::id_less>      TableMap;
+    typedef std::map<cstring, FuncInfo, cstring::id_less>       FuncMap;
+    TableMap                            &tables;
+    FuncMap                             &actions;
+    FuncMap                             &methods;
+    FuncMap                             &states;
     TableInfo                           *inferForTable = nullptr;
     FuncInfo                            *inferForFunc = nullptr;
     bool                                need_key_rewrite = false;
@@ -80,7 +122,11 @@ class DoLocalCopyPropagation : public ControlFlowVisitor, Transform, P4WriteCont
 
     DoLocalCopyPropagation *clone() const override { return new DoLocalCopyPropagation(*this); }
     void flow_merge(Visitor &) override;
-    bool name_overlap(cstring, cstring);
+    int findVarId(cstring name) const;
+    const VarInfo *findVar(cstring name) const { return available.get(findVarId(name)); }
+    VarInfo &varInfo(cstring name);
+    void setValue(cstring name, const IR::Expression *val);
+    void clearAvailable();
     void forOverlapAvail(cstring, std::function<void(cstring, VarInfo *)>);
     void dropValuesUsing(cstring);
     bool hasSideEffects(const IR::Expression *e) {
@@ -118,9 +164,9 @@ class DoLocalCopyPropagation : public ControlFlowVisitor, Transform, P4WriteCont
  public:
     DoLocalCopyPropagation(ReferenceMap* refMap, TypeMap* typeMap,
         std::function<bool(const Context *, const IR::Expression *)> policy, bool eut)
-    : refMap(refMap), typeMap(typeMap), tables(*new std::map<cstring, TableInfo>),
-      actions(*new std::map<cstring, FuncInfo>), methods(*new std::map<cstring, FuncInfo>),
-      states(*new std::map<cstring, FuncInfo>), policy(policy), elimUnusedTables(eut) {}
+    : refMap(refMap), typeMap(typeMap), varIndex(new VarIndex), tables(*new TableMap),
+      actions(*new FuncMap), methods(*new FuncMap), states(*new FuncMap), policy(policy),
+      elimUnusedTables(eut) {}
 };
 
 class LocalCopyPropagation : public PassManager {
@@ -21,31 +21,38 @@ struct VisitedKey {
 
     /// Checks of two states to be less. If @a name < @a e.name then it returns @a true.
     /// if @a name > @a e.name then it returns false.
-    /// If @a name is equal @a e.name then it checks the values of the headers stack indexes.
-    /// For both map of header stacks' indexes it creates map of pairs of values for each
-    /// header stack index.
+    /// If @a name is equal @a e.name then it checks the values of the headers stack indexes,
+    /// walking both maps of header stacks' indexes in key order.
     /// If some indexes are missing then it cosiders them as -1.
-    /// Next, it continues checking each pair in a intermidiate map with the same approach
-    /// as for @a name and @a e.name.
+    /// Each pair of indexes is checked with the same approach as for @a name and @a e.name.
+    /// This is called for every lookup in the visited set, so it does not allocate.
     bool operator<(const VisitedKey& e) const {
         if (name < e.name)
             return true;
         if (name > e.name)
             return false;
-        std::map<cstring, std::pair<size_t, size_t> > mp;
-        for (auto& i1 : indexes)
-            mp.emplace(i1.first, std::make_pair(i1.second, -1));
-        for (auto& i2 : e.indexes) {
-            auto ref = mp.find(i2.first);
-            if (ref == mp.end())
-                mp.emplace(i2.first, std::make_pair(-1, i2.second));
-            else
-                ref->second.second = i2.second;
-        }
-        for (auto j : mp) {
-            if (j.second.first < j.second.second)
+        const size_t missing = -1;
+        auto i1 = indexes.begin();
+        auto i2 = e.indexes.begin();
+        while (i1 != indexes.end() || i2 != e.indexes.end()) {
+            size_t v1, v2;
+            if (i2 == e.indexes.end() || (i1 != indexes.end() && i1->first < i2->first)) {
+                v1 = i1->second;
+                v2 = missing;
+                ++i1;
+            } else if (i1 == indexes.end() || i2->first < i1->first) {
+                v1 = missing;
+                v2 = i2->second;
+                ++i2;
+            } else {
+                v1 = i1->second;
+                v2 = i2->second;
+                ++i1;
+                ++i2;
+            }
+            if (v1 < v2)
                 return true;
-            if (j.second.first > j.second.second)
+            if (v1 > v2)
                 return false;
         }
         return false;
@@ -286,14 +293,17 @@ class ParserSymbolicInterpreter {
         return result;
     }
 
+    /// The @values are shared, not copied: the 'before' map of a state is never
+    /// modified (evaluateState works on a clone), so all the successors of a
+    /// state can use its 'after' map directly.
     ParserStateInfo* newStateInfo(const ParserStateInfo* predecessor,
                                   cstring stateName, ValueMap* values, size_t index) {
         if (stateName == IR::ParserState::accept ||
             stateName == IR::ParserState::reject)
             return nullptr;
         auto state = structure->get(stateName);
-        auto pi = new ParserStateInfo(stateName, parser, state, predecessor, values->clone(),
-                                      index);
+        auto pi = new ParserStateInfo(stateName, parser, state, predecessor,
+                                      predecessor ? values : values->clone(), index);
         synthesizedParser->add(pi);
         return pi;
     }
@@ -609,14 +619,15 @@ class ParserSymbolicInterpreter {
             LOG1("Symbolic evaluation of " << stateChain(stateInfo));
             // checking visited state, loop state, and the reachable states with needed header stack
             // operators.
-            if (visited.count(VisitedKey(stateInfo)) &&
+            VisitedKey key(stateInfo);
+            if (visited.count(key) &&
                 !stateInfo->scenarioStates.count(stateInfo->name) &&
                 !structure->reachableHSUsage(stateInfo->state->name, stateInfo))
                 continue;
             auto iHSNames = structure->statesWithHeaderStacks.find(stateInfo->name);
             if (iHSNames != structure->statesWithHeaderStacks.end())
                 stateInfo->scenarioHS.insert(iHSNames->second.begin(), iHSNames->second.end());
-            visited.insert(VisitedKey(stateInfo));  // add to visited map
+            visited.insert(std::move(key));  // add to visited map
             stateInfo->scenarioStates.insert(stateInfo->name);  // add to loops detection
             bool infLoop = checkLoops(stateInfo);
             if (infLoop)
@@ -652,9 +663,20 @@ bool ParserStructure::analyze(ReferenceMap* refMap, TypeMap* typeMap, bool unrol
 }
 
 /// check reachability for usage of header stack
-bool ParserStructure::reachableHSUsage(IR::ID id, const ParserStateInfo* state) const {
+bool ParserStructure::reachableHSUsage(IR::ID id, const ParserStateInfo* state) {
     if (!state->scenarioHS.size())
         return false;
+    auto& reachebleHSoperators = reachableHSOperators(id);
+    for (auto& hs : state->scenarioHS)
+        if (reachebleHSoperators.count(hs))
+            return true;
+    return false;
+}
+
+const std::set<cstring>& ParserStructure::reachableHSOperators(IR::ID id) {
+    auto cached = reachableHS.find(id.name);
+    if (cached != reachableHS.end())
+        return cached->second;
     CHECK_NULL(callGraph);
     const IR::IDeclaration* declaration = parser->states.getDeclaration(id.name);
     BUG_CHECK(declaration && declaration->is<IR::ParserState>(), "Invalid declaration %1%", id);
@@ -666,12 +688,7 @@ bool ParserStructure::reachableHSUsage(IR::ID id, const ParserStateInfo* state)
         if (iHSNames != statesWithHeaderStacks.end())
             reachebleHSoperators.insert(iHSNames->second.begin(), iHSNames->second.end());
     }
-    std::set<cstring> intersectionHSOperators;
-    std::set_intersection(state->scenarioHS.begin(), state->scenarioHS.end(),
-                            reachebleHSoperators.begin(), reachebleHSoperators.end(),
-                            std::inserter(intersectionHSOperators,
-                                          intersectionHSOperators.begin()));
-    return intersectionHSOperators.size() > 0;
+    return reachableHS.emplace(id.name, std::move(reachebleHSoperators)).first->second;
 }
 
 void ParserStructure::addStateHSUsage(const IR::ParserState* state,
@@ -117,9 +117,13 @@ class ParserStructure {
 
     bool analyze(ReferenceMap* refMap, TypeMap* typeMap, bool unroll);
     /// check reachability for usage of header stack
-    bool reachableHSUsage(IR::ID id, const ParserStateInfo* state) const;
+    bool reachableHSUsage(IR::ID id, const ParserStateInfo* state);
 
  protected:
+    /// Header stacks used by the states reachable from state @id, computed
+    /// once per state: the call graph does not change during unrolling.
+    std::map<cstring, std::set<cstring>> reachableHS;
+    const std::set<cstring>& reachableHSOperators(IR::ID id);
     /// evaluates rechable states with HS operations for each path.
     void evaluateReachability();
     /// add HS name which is used in a current state.
@@ -14,8 +14,16 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <map>
+#include <string>
+#ifdef MULTITHREAD
+#include <thread>
+#include <vector>
+#endif  // MULTITHREAD
+
 #include "gtest/gtest.h"
 #include "lib/cstring.h"
+#include "lib/gc.h"
 
 namespace Test {
 
@@ -110,4 +118,65 @@ TEST(cstring, replace) {
     EXPECT_EQ(c.replace("i", ""), "Orgnal");
 }
 
+TEST(cstring, id) {
+    cstring c = "interned";
+    cstring c1 = std::string("interned");
+    cstring c2 = cstring::literal("other");
+    cstring n;
+
+    EXPECT_EQ(c.id(), c1.id());
+    EXPECT_NE(c.id(), c2.id());
+    EXPECT_EQ(n.id(), 0u);
+    EXPECT_NE(cstring::empty.id(), 0u);
+    EXPECT_EQ(c.hash(), c1.hash());
+    EXPECT_EQ(std::hash<cstring>()(c), c.hash());
+    EXPECT_EQ(c2.size(), strlen("other"));
+    EXPECT_EQ(cstring("with\0null", 9).size(), strlen("with"));
+
+    std::map<cstring, int, cstring::id_less> m;
+    m[c] = 1;
+    m[c2] = 2;
+    m[c1] = 3;
+    EXPECT_EQ(m.size(), 2u);
+    EXPECT_EQ(m.at(c), 3);
+    EXPECT_EQ(m.count("other"), 1u);
+    EXPECT_EQ(m.count("missing"), 0u);
+}
+
+TEST(cstring, get_interned) {
+    cstring c = "interned";
+    size_t count, size = cstring::cache_size(count);
+
+    EXPECT_EQ(cstring::get_interned(std::string("interned")), c);
+    EXPECT_TRUE(cstring::get_interned(std::string("never interned")).isNull());
+    EXPECT_TRUE(cstring::get_interned("interned", 5).isNull());
+    size_t count1, size1 = cstring::cache_size(count1);
+    EXPECT_EQ(count, count1);
+    EXPECT_EQ(size, size1);
+}
+
+#ifdef MULTITHREAD
+TEST(cstring, threads) {
+    // every thread interns the same strings; each must end up with a single copy
+    const int threads = 4, strings = 1000;
+    std::vector<std::vector<cstring>> interned(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([t, &interned]() {
+            gc_thread_registration gc;
+            for (int i = 0; i < strings; i++)
+                interned[t].emplace_back("thread string " + std::to_string(i));
+        });
+    for (auto &w : workers)
+        w.join();
+
+    for (int i = 0; i < strings; i++) {
+        for (int t = 1; t < threads; t++) {
+            EXPECT_EQ(interned[0][i].c_str(), interned[t][i].c_str());
+            EXPECT_EQ(interned[0][i].id(), interned[t][i].id());
+        }
+    }
+}
+#endif  // MULTITHREAD
+
 }  // namespace Test
@@ -0,0 +1,90 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lib/iterator_range.h"
+
+namespace Util {
+
+class UtilIteratorRange : public ::testing::Test {
+ protected:
+    class A {
+     public:
+        int a;
+        explicit A(int a) : a(a) {}
+        virtual ~A() {}
+    };
+
+    class B : public A {
+     public:
+        explicit B(int b) : A(b) {}
+    };
+
+    std::vector<int> vec{ 1, 2, 3 };
+};
+
+TEST_F(UtilIteratorRange, Range) {
+    int sum = 0;
+    for (auto a : make_range(vec))
+        sum += a;
+    EXPECT_EQ(6, sum);
+    EXPECT_EQ(3u, make_range(vec).count());
+    EXPECT_FALSE(make_range(vec).empty());
+    EXPECT_TRUE(make_range(vec.end(), vec.end()).empty());
+}
+
+TEST_F(UtilIteratorRange, Linq) {
+    // where
+    auto isEven = [](int x) { return x % 2 == 0; };
+    auto even = make_range(vec).where(isEven).toVector();
+    EXPECT_EQ(std::vector<int>({ 2 }), even);
+    EXPECT_FALSE(make_range(vec).where([](int x) { return x > 3; }).any());
+
+    // map
+    auto increment = [](int x) { return x + 1; };
+    auto inc = make_range(vec).map(increment);
+    EXPECT_EQ(std::vector<int>({ 2, 3, 4 }), inc.toVector());
+    // ranges can be iterated more than once
+    EXPECT_EQ(std::vector<int>({ 2, 3, 4 }), inc.toVector());
+
+    // where and map compose
+    EXPECT_EQ(std::vector<int>({ 2, 4 }), inc.where(isEven).toVector());
+
+    // concat
+    auto cc = make_range(vec).concat(make_range(vec)).concat(make_range(vec));
+    EXPECT_EQ(9u, cc.count());
+    EXPECT_EQ(std::vector<int>({ 2, 2, 2 }), cc.where(isEven).toVector());
+    std::vector<int> none;
+    EXPECT_EQ(vec, make_range(none).concat(make_range(vec)).toVector());
+    EXPECT_EQ(vec, make_range(vec).concat(make_range(none)).toVector());
+
+    // as
+    std::vector<A*> as;
+    as.push_back(new B(1));
+    as.push_back(new A(2));
+    as.push_back(new B(3));
+    auto bs = make_range(as).as<B*>().where([](B* b) { return b != nullptr; });
+    EXPECT_EQ(2u, bs.count());
+    EXPECT_EQ(1, bs.nextOrDefault()->a);
+
+    // nextOrDefault
+    EXPECT_EQ(1, make_range(vec).nextOrDefault());
+    EXPECT_EQ(0, make_range(none).nextOrDefault());
+}
+
+}  // namespace Util
@@ -23,6 +23,7 @@ limitations under the License.
 #include "frontends/common/resolveReferences/referenceMap.h"
 #include "frontends/p4/typeMap.h"
 #include "midend/convertEnums.h"
+#include "midend/local_copyprop.h"
 
 using namespace P4;
 
@@ -109,4 +110,41 @@ TEST_F(P4CMidend, getEnumMapping) {
     ASSERT_EQ(enumMap.size(), (unsigned long)1);
 }
 
+// LocalCopyPropagation clears its state at the end of every action and control.
+TEST_F(P4CMidend, localCopyPropagation) {
+    auto test = FrontendTestCase::create(P4_SOURCE(P4Headers::CORE, R"(
+        control c(inout bit<8> x, out bit<8> y, out bit<8> z) {
+            action a() { bit<8> u = x; y = u + 1; }
+            table tt { actions = { a; } default_action = a(); }
+            apply {
+                bit<8> t = x;
+                z = t + 2;
+                tt.apply();
+            }
+        }
+        control proto(inout bit<8> x, out bit<8> y, out bit<8> z);
+        package top(proto p);
+        top(c()) main;
+    )"));
+    ASSERT_TRUE(test);
+
+    ReferenceMap  refMap;
+    TypeMap       typeMap;
+    auto result = test->program->apply(LocalCopyPropagation(&refMap, &typeMap));
+    ASSERT_TRUE(result != nullptr && ::errorCount() == 0);
+
+    // The locals are replaced by x in the assignments to y and z.
+    unsigned assignments = 0;
+    forAllMatching<IR::AssignmentStatement>(result, [&](const IR::AssignmentStatement* s) {
+        auto left = s->left->to<IR::PathExpression>();
+        if (!left || (left->path->name.name != "y" && left->path->name.name != "z"))
+            return;
+        assignments++;
+        forAllMatching<IR::PathExpression>(s->right, [](const IR::PathExpression* pe) {
+            EXPECT_EQ("x", pe->path->name.name);
+        });
+    });
+    EXPECT_EQ(2u, assignments);
+}
+
 }  // namespace Test
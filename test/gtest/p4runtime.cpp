@@ -16,9 +16,12 @@ limitations under the License.
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/util/delimited_message_util.h>
 #include <google/protobuf/util/message_differencer.h>
 
 #include <iterator>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -1170,6 +1173,75 @@ TEST_F(P4Runtime, StaticTableEntries) {
     }
 }
 
+TEST_F(P4Runtime, StaticTableEntriesDelimited) {
+    auto program = P4_SOURCE(P4Headers::V1MODEL, R"(
+        header Header { bit<8> hfA; bit<16> hfB; }
+        struct Headers { Header h; }
+        struct Metadata { }
+
+        parser parse(packet_in p, out Headers h, inout Metadata m,
+                     inout standard_metadata_t sm) {
+            state start { p.extract(h.h); transition accept; } }
+        control verifyChecksum(inout Headers h, inout Metadata m) { apply { } }
+        control egress(inout Headers h, inout Metadata m,
+                        inout standard_metadata_t sm) { apply { } }
+        control computeChecksum(inout Headers h, inout Metadata m) { apply { } }
+        control deparse(packet_out p, in Headers h) { apply { } }
+
+        control ingress(inout Headers h, inout Metadata m,
+                        inout standard_metadata_t sm) {
+            action a() { sm.egress_spec = 0; }
+            action a_with_control_params(bit<9> x) { sm.egress_spec = x; }
+
+            table t_exact_ternary {
+                key = { h.h.hfA : exact; h.h.hfB : ternary; }
+                actions = { a; a_with_control_params; }
+                default_action = a;
+                const entries = {
+                    (0x01, 0x1000 &&& 0xF000) : a_with_control_params(1);
+                    (0x02, 0x1181           ) : a_with_control_params(2);
+                    (0x03, _                ) : a_with_control_params(3);
+                }
+            }
+            apply { t_exact_ternary.apply(); }
+        }
+        V1Switch(parse(), verifyChecksum(), ingress(), egress(),
+                 computeChecksum(), deparse()) main;
+    )");
+    auto frontendTestCase = FrontendTestCase::create(program);
+    ASSERT_TRUE(frontendTestCase);
+
+    auto serializer = P4::P4RuntimeSerializer::get();
+    auto inMemory = serializer->generateP4Runtime(frontendTestCase->program, defaultArch);
+    std::stringstream streamed;
+    auto test = serializer->generateP4Runtime(frontendTestCase->program, defaultArch,
+                                              { &streamed });
+    EXPECT_EQ(0u, ::diagnosticCount());
+    // Streamed entries are not kept in memory.
+    EXPECT_EQ(0, test.entries->updates_size());
+    ASSERT_EQ(3, inMemory.entries->updates_size());
+
+    // Serializing the in-memory entries as delimited messages must produce the
+    // same output as streaming them.
+    std::stringstream serialized;
+    inMemory.serializeEntriesTo(&serialized, P4::P4RuntimeFormat::DELIMITED);
+    EXPECT_EQ(serialized.str(), streamed.str());
+
+    google::protobuf::io::IstreamInputStream input(&streamed);
+    for (const auto& expected : inMemory.entries->updates()) {
+        p4v1::Update update;
+        bool cleanEof = false;
+        ASSERT_TRUE(google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+            &update, &input, &cleanEof));
+        EXPECT_TRUE(MessageDifferencer::Equals(expected, update));
+    }
+    p4v1::Update update;
+    bool cleanEof = false;
+    EXPECT_FALSE(google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+        &update, &input, &cleanEof));
+    EXPECT_TRUE(cleanEof);
+}
+
 TEST_F(P4Runtime, IsConstTable) {
     auto test = createP4RuntimeTestCase(P4_SOURCE(P4Headers::V1MODEL, R"(
         header Header { bit<8> hfA; }
@@ -0,0 +1,39 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+#include "frontends/common/resolveReferences/referenceMap.h"
+
+namespace Test {
+
+TEST(ReferenceMap, newName) {
+    P4::ReferenceMap refMap;
+
+    EXPECT_EQ(refMap.newName("tmp"), "tmp");
+    EXPECT_EQ(refMap.newName("tmp"), "tmp_0");
+    EXPECT_EQ(refMap.newName("tmp_0"), "tmp_1");
+    refMap.usedName("tmp_3");
+    EXPECT_EQ(refMap.newName("tmp"), "tmp_2");
+    EXPECT_EQ(refMap.newName("tmp"), "tmp_4");
+    // reserved words are never generated
+    EXPECT_EQ(refMap.newName("table"), "table_0");
+
+    refMap.clear();
+    EXPECT_EQ(refMap.newName("tmp"), "tmp");
+    EXPECT_EQ(refMap.newName("tmp"), "tmp_0");
+}
+
+}  // namespace Test
@@ -0,0 +1,128 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "ir/ir.h"
+#include "helpers.h"
+#include "tools/stress-gen/stressgen.h"
+
+namespace Test {
+
+namespace {
+
+StressGen::StressOptions smallProgram(StressGen::Arch arch) {
+    StressGen::StressOptions options;
+    options.arch = arch;
+    options.tables = 5;
+    options.actions = 3;
+    options.keyFields = 2;
+    options.parserStates = 3;
+    options.nesting = 2;
+    options.entries = 4;
+    return options;
+}
+
+/// Prints the generated program after the architecture headers, as the
+/// preprocessor would have expanded its #includes.
+std::string source(const StressGen::StressOptions &options, const std::string &headers) {
+    std::stringstream out;
+    out << headers;
+    StressGen::emitProgram(out, StressGen::generateProgram(options), options.arch, false);
+    return out.str();
+}
+
+const IR::P4Control* findControl(const IR::P4Program* program, cstring name) {
+    for (auto decl : program->objects) {
+        if (auto control = decl->to<IR::P4Control>())
+            if (control->name == name)
+                return control;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+class StressProgram : public P4CTest { };
+
+TEST_F(StressProgram, Shape) {
+    auto options = smallProgram(StressGen::Arch::V1Model);
+    auto program = StressGen::generateProgram(options);
+    auto ingress = findControl(program, "StressIngress");
+    ASSERT_NE(nullptr, ingress);
+
+    unsigned tables = 0, actions = 0;
+    for (auto decl : ingress->controlLocals) {
+        if (auto table = decl->to<IR::P4Table>()) {
+            tables++;
+            EXPECT_EQ(options.keyFields, table->getKey()->keyElements.size());
+            ASSERT_NE(nullptr, table->getEntries());
+            EXPECT_EQ(options.entries, table->getEntries()->size());
+        } else if (decl->is<IR::P4Action>()) {
+            actions++;
+        }
+    }
+    EXPECT_EQ(options.tables, tables);
+    EXPECT_EQ(options.actions, actions);
+}
+
+TEST_F(StressProgram, V1Model) {
+    auto options = smallProgram(StressGen::Arch::V1Model);
+    auto test = FrontendTestCase::create(
+        source(options, P4CTestEnvironment::get()->v1Model()));
+    ASSERT_TRUE(test);
+    EXPECT_NE(nullptr, findControl(test->program, "StressIngress"));
+}
+
+TEST_F(StressProgram, PSA) {
+    auto options = smallProgram(StressGen::Arch::PSA);
+    auto env = P4CTestEnvironment::get();
+    auto test = FrontendTestCase::create(source(options, env->coreP4() + env->psaP4()));
+    ASSERT_TRUE(test);
+    EXPECT_NE(nullptr, findControl(test->program, "StressIngress"));
+}
+
+TEST_F(StressProgram, EBPF) {
+    auto options = smallProgram(StressGen::Arch::EBPF);
+    auto program = StressGen::generateProgram(options);
+    auto pipe = findControl(program, "pipe");
+    ASSERT_NE(nullptr, pipe);
+    for (auto decl : pipe->controlLocals) {
+        if (auto table = decl->to<IR::P4Table>())
+            EXPECT_NE(nullptr, table->properties->getProperty("implementation"));
+    }
+
+    std::stringstream out;
+    StressGen::emitProgram(out, program, options.arch);
+    EXPECT_EQ(0u, out.str().find("#include <core.p4>\n#include <ebpf_model.p4>\n"));
+}
+
+TEST_F(StressProgram, Degenerate) {
+    // Zero counts still produce a well-formed program.
+    StressGen::StressOptions options;
+    options.tables = 0;
+    options.actions = 0;
+    options.keyFields = 0;
+    options.parserStates = 0;
+    options.nesting = 0;
+    auto test = FrontendTestCase::create(
+        source(options, P4CTestEnvironment::get()->v1Model()));
+    ASSERT_TRUE(test);
+}
+
+}  // namespace Test
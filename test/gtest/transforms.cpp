@@ -14,9 +14,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <map>
+#include <string>
+
 #include "gtest/gtest.h"
 #include "helpers.h"
 #include "ir/ir.h"
+#include "ir/pass_manager.h"
 #include "ir/visitor.h"
 #include "lib/source_file.h"
 
@@ -43,4 +47,123 @@ TEST_F(P4C_IR, Transform) {
     EXPECT_EQ(e, n);
 }
 
+TEST_F(P4C_IR, PerDeclaration) {
+    // Renames y, removes z, and checks that each object is visited with the
+    // program as its parent.
+    struct Rename : public Transform {
+        unsigned visits = 0;
+        const IR::Node* postorder(IR::Declaration_Constant* d) override {
+            visits++;
+            EXPECT_NE(nullptr, getParent<IR::P4Program>());
+            if (d->name.name == "z")
+                return nullptr;
+            if (d->name.name == "y")
+                d->name = IR::ID("y2");
+            return d;
+        }
+    };
+
+    IR::Vector<IR::Node> objects;
+    for (auto name : { "x", "y", "z", "w" })
+        objects.push_back(new IR::Declaration_Constant(
+            IR::ID(name), IR::Type_Bits::get(8), new IR::Constant(IR::Type_Bits::get(8), 1)));
+    auto program = new IR::P4Program(objects);
+
+    auto rename = new Rename;
+    auto result = program->apply(PerDeclaration(rename))->to<IR::P4Program>();
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(4u, rename->visits);
+    ASSERT_EQ(3u, result->objects.size());
+    EXPECT_EQ("x", result->objects.at(0)->to<IR::Declaration_Constant>()->name.name);
+    EXPECT_EQ("y2", result->objects.at(1)->to<IR::Declaration_Constant>()->name.name);
+    EXPECT_EQ("w", result->objects.at(2)->to<IR::Declaration_Constant>()->name.name);
+
+    // A pass that changes nothing returns the program itself.
+    struct Nothing : public Transform { };
+    EXPECT_EQ(result, result->apply(PerDeclaration(new Nothing)));
+}
+
+#ifdef MULTITHREAD
+TEST_F(P4C_IR, PerDeclarationParallel) {
+    // Renames the constants with even values and removes the others, on
+    // whichever thread picks them up.
+    struct Rename : public Transform {
+        Rename* clone() const override { return new Rename(*this); }
+        const IR::Node* postorder(IR::Declaration_Constant* d) override {
+            EXPECT_NE(nullptr, getParent<IR::P4Program>());
+            if (d->initializer->to<IR::Constant>()->asInt() % 2)
+                return nullptr;
+            d->name = IR::ID(d->name.name + "_even");
+            return d;
+        }
+    };
+
+    auto type = IR::Type_Bits::get(8);
+    IR::Vector<IR::Node> objects;
+    for (int i = 0; i < 64; ++i)
+        objects.push_back(new IR::Declaration_Constant(
+            IR::ID(cstring("c" + std::to_string(i))), type, new IR::Constant(type, i)));
+    auto program = new IR::P4Program(objects);
+
+    auto result = program->apply(*(new PerDeclaration(new Rename))->setParallel());
+    ASSERT_NE(nullptr, result->to<IR::P4Program>());
+    auto &rebuilt = result->to<IR::P4Program>()->objects;
+    ASSERT_EQ(32u, rebuilt.size());
+    for (int i = 0; i < 32; ++i)
+        EXPECT_EQ(cstring("c" + std::to_string(2 * i) + "_even"),
+                  rebuilt.at(i)->to<IR::Declaration_Constant>()->name.name);
+
+    // An error on one of the threads is reported on the calling thread.
+    struct Fail : public Transform {
+        Fail* clone() const override { return new Fail(*this); }
+        const IR::Node* postorder(IR::Declaration_Constant* d) override {
+            BUG_CHECK(d->name.name != "c17", "%1%: cannot rewrite", d);
+            return d;
+        }
+    };
+    EXPECT_THROW(program->apply(*(new PerDeclaration(new Fail))->setParallel()),
+                 Util::CompilerBug);
+}
+#endif  // MULTITHREAD
+
+TEST_F(P4C_IR, PassRepeatedWorklist) {
+    // The first repeat rewrites y; the second revisits y and z, which uses y,
+    // but not x, and changes nothing.
+    struct Count : public Transform {
+        std::map<cstring, unsigned> visits;
+        const IR::Node* postorder(IR::Declaration_Constant* d) override {
+            visits[d->name.name]++;
+            auto value = d->initializer->to<IR::Constant>();
+            if (d->name.name == "y" && value && value->value == 1)
+                d->initializer = new IR::Constant(IR::Type_Bits::get(8), 2);
+            return d;
+        }
+    };
+
+    auto type = IR::Type_Bits::get(8);
+    auto program = new IR::P4Program(IR::Vector<IR::Node>({
+        new IR::Declaration_Constant(IR::ID("x"), type, new IR::Constant(type, 1)),
+        new IR::Declaration_Constant(IR::ID("y"), type, new IR::Constant(type, 1)),
+        new IR::Declaration_Constant(IR::ID("z"), type, new IR::PathExpression(IR::ID("y"))),
+    }));
+
+    auto count = new Count;
+    auto repeated = (new PassRepeated({ new PerDeclaration(count) }))->setWorklist();
+    double totalSaved = PassRepeated::totalIterationsSaved();
+    auto result = program->apply(*repeated)->to<IR::P4Program>();
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(1u, count->visits["x"]);
+    EXPECT_EQ(2u, count->visits["y"]);
+    EXPECT_EQ(2u, count->visits["z"]);
+    EXPECT_EQ(1u, repeated->skippedDeclarations());
+    EXPECT_DOUBLE_EQ(1.0 / 3, repeated->iterationsSaved());
+    // The --timing-log profile reports the savings from the running totals.
+    EXPECT_DOUBLE_EQ(totalSaved + 1.0 / 3, PassRepeated::totalIterationsSaved());
+
+    // Without the worklist, every repeat visits every declaration.
+    count = new Count;
+    program->apply(PassRepeated({ new PerDeclaration(count) }));
+    EXPECT_EQ(2u, count->visits["x"]);
+}
+
 }  // namespace Test
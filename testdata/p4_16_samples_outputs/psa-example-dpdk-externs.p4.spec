@@ -53,9 +53,9 @@ struct metadata_t {
 	bit<8> psa_egress_output_metadata_drop
 	bit<32> local_metadata_port_in
 	bit<32> local_metadata_port_out
+	bit<32> Ingress_tmp
 	bit<32> Ingress_color_out_0
 	bit<32> Ingress_color_in_0
-	bit<32> Ingress_tmp
 }
 metadata instanceof metadata_t
 
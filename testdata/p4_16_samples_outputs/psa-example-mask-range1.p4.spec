@@ -66,11 +66,9 @@ struct metadata {
 	bit<8> psa_egress_output_metadata_drop
 	bit<16> local_metadata_data
 	bit<8> local_metadata_tmpMask
-	bit<16> Ingress_tmpMask_1
 	bit<16> tmpMask
 	bit<8> tmpMask_0
-	bit<16> tmpMask_1
-	bit<8> tmpMask_2
+	bit<16> Ingress_tmpMask_1
 }
 metadata instanceof metadata
 
@@ -141,14 +139,14 @@ apply {
 	emit h.ipv4
 	emit h.tcp
 	extract h.ethernet
-	mov m.tmpMask_1 h.ethernet.etherType
-	and m.tmpMask_1 0xc0
-	jmpeq EGRESSPARSERIMPL_PARSE_IPV4 m.tmpMask_1 0x80
+	mov m.tmpMask h.ethernet.etherType
+	and m.tmpMask 0xc0
+	jmpeq EGRESSPARSERIMPL_PARSE_IPV4 m.tmpMask 0x80
 	jmp EGRESSPARSERIMPL_ACCEPT
 	EGRESSPARSERIMPL_PARSE_IPV4 :	extract h.ipv4
-	mov m.tmpMask_2 h.ipv4.protocol
-	and m.tmpMask_2 0xf8
-	jmpeq EGRESSPARSERIMPL_PARSE_TCP m.tmpMask_2 0x10
+	mov m.tmpMask_0 h.ipv4.protocol
+	and m.tmpMask_0 0xf8
+	jmpeq EGRESSPARSERIMPL_PARSE_TCP m.tmpMask_0 0x10
 	jmp EGRESSPARSERIMPL_ACCEPT
 	EGRESSPARSERIMPL_PARSE_TCP :	extract h.tcp
 	EGRESSPARSERIMPL_ACCEPT :	emit h.ethernet
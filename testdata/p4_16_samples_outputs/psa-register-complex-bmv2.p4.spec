@@ -32,9 +32,6 @@ struct metadata_t {
 	bit<8> psa_egress_output_metadata_clone
 	bit<16> psa_egress_output_metadata_clone_session_id
 	bit<8> psa_egress_output_metadata_drop
-	bit<48> Ingress_tmp_2
-	bit<48> Ingress_tmp_3
-	bit<48> Ingress_tmp
 	bit<48> Ingress_tmp_0
 	bit<48> Ingress_tmp_1
 }
@@ -72,15 +69,12 @@ apply {
 	regwr regfile_0 0x2 0x4
 	regrd m.Ingress_tmp_0 regfile_0 0x1
 	regrd m.Ingress_tmp_1 regfile_0 0x2
-	mov m.Ingress_tmp m.Ingress_tmp_0
-	add m.Ingress_tmp m.Ingress_tmp_1
-	mov h.ethernet.dstAddr m.Ingress_tmp
+	mov h.ethernet.dstAddr m.Ingress_tmp_0
+	add h.ethernet.dstAddr m.Ingress_tmp_1
 	add h.ethernet.dstAddr 0xfffffffffffb
-	mov m.Ingress_tmp_2 m.Ingress_tmp_0
-	add m.Ingress_tmp_2 m.Ingress_tmp_1
-	mov m.Ingress_tmp_3 m.Ingress_tmp_2
-	add m.Ingress_tmp_3 0xfffffffffffb
-	jmpneq LABEL_0END m.Ingress_tmp_3 0x2
+	add m.Ingress_tmp_0 m.Ingress_tmp_1
+	add m.Ingress_tmp_0 0xfffffffffffb
+	jmpneq LABEL_0END m.Ingress_tmp_0 0x2
 	mov m.psa_ingress_output_metadata_drop 0
 	mov m.psa_ingress_output_metadata_multicast_group 0x0
 	cast  h.ethernet.dstAddr bit_32 m.psa_ingress_output_metadata_egress_port
@@ -0,0 +1,181 @@
+
+struct ethernet_t {
+	bit<48> dstAddr
+	bit<48> srcAddr
+	bit<16> etherType
+}
+
+struct ipv4_t {
+	bit<4> version
+	bit<4> ihl
+	bit<8> diffserv
+	bit<16> totalLen
+	bit<16> identification
+	bit<3> flags
+	bit<13> fragOffset
+	bit<8> ttl
+	bit<8> protocol
+	bit<16> hdrChecksum
+	bit<32> srcAddr
+	bit<32> dstAddr
+}
+
+struct EMPTY_M {
+	bit<32> t_ip_0_ipv4_srcAddr
+	bit<32> t_ip_0_ipv4_dstAddr
+	bit<8> t_ip_0_ipv4_protocol
+	bit<56> key_pad
+	bit<48> t_eth_0_ethernet_dstAddr
+	bit<8> t_eth_0_ipv4_ttl
+	bit<32> psa_ingress_parser_input_metadata_ingress_port
+	bit<32> psa_ingress_parser_input_metadata_packet_path
+	bit<32> psa_egress_parser_input_metadata_egress_port
+	bit<32> psa_egress_parser_input_metadata_packet_path
+	bit<32> psa_ingress_input_metadata_ingress_port
+	bit<32> psa_ingress_input_metadata_packet_path
+	bit<64> psa_ingress_input_metadata_ingress_timestamp
+	bit<8> psa_ingress_input_metadata_parser_error
+	bit<8> psa_ingress_output_metadata_class_of_service
+	bit<8> psa_ingress_output_metadata_clone
+	bit<16> psa_ingress_output_metadata_clone_session_id
+	bit<8> psa_ingress_output_metadata_drop
+	bit<8> psa_ingress_output_metadata_resubmit
+	bit<32> psa_ingress_output_metadata_multicast_group
+	bit<32> psa_ingress_output_metadata_egress_port
+	bit<8> psa_egress_input_metadata_class_of_service
+	bit<32> psa_egress_input_metadata_egress_port
+	bit<32> psa_egress_input_metadata_packet_path
+	bit<16> psa_egress_input_metadata_instance
+	bit<64> psa_egress_input_metadata_egress_timestamp
+	bit<8> psa_egress_input_metadata_parser_error
+	bit<32> psa_egress_deparser_input_metadata_egress_port
+	bit<8> psa_egress_output_metadata_clone
+	bit<16> psa_egress_output_metadata_clone_session_id
+	bit<8> psa_egress_output_metadata_drop
+}
+metadata instanceof EMPTY_M
+
+header ethernet instanceof ethernet_t
+header ipv4 instanceof ipv4_t
+
+struct forward_arg_t {
+	bit<32> port
+}
+
+struct psa_ingress_output_metadata_t {
+	bit<8> class_of_service
+	bit<8> clone
+	bit<16> clone_session_id
+	bit<8> drop
+	bit<8> resubmit
+	bit<32> multicast_group
+	bit<32> egress_port
+}
+
+struct psa_egress_output_metadata_t {
+	bit<8> clone
+	bit<16> clone_session_id
+	bit<8> drop
+}
+
+struct psa_egress_deparser_input_metadata_t {
+	bit<32> egress_port
+}
+
+action NoAction args none {
+	return
+}
+
+action forward args instanceof forward_arg_t {
+	mov m.psa_ingress_output_metadata_egress_port t.port
+	return
+}
+
+action drop args none {
+	mov m.psa_ingress_output_metadata_drop 1
+	return
+}
+
+table t_ip {
+	key {
+		m.t_ip_0_ipv4_srcAddr exact
+		m.t_ip_0_ipv4_dstAddr exact
+		m.t_ip_0_ipv4_protocol exact
+	}
+	actions {
+		forward
+		drop
+	}
+	default_action drop args none 
+	size 0x10000
+}
+
+
+table t_flow {
+	key {
+		m.t_ip_0_ipv4_dstAddr exact
+		m.t_ip_0_ipv4_protocol exact
+	}
+	actions {
+		forward
+		NoAction
+	}
+	default_action NoAction args none 
+	size 0x10000
+}
+
+
+table t_addr {
+	key {
+		h.ipv4.srcAddr exact
+		h.ipv4.dstAddr exact
+	}
+	actions {
+		forward
+		NoAction
+	}
+	default_action NoAction args none 
+	size 0x10000
+}
+
+
+table t_eth {
+	key {
+		m.t_eth_0_ethernet_dstAddr exact
+		m.t_eth_0_ipv4_ttl exact
+	}
+	actions {
+		forward
+		drop
+	}
+	default_action drop args none 
+	size 0x10000
+}
+
+
+apply {
+	rx m.psa_ingress_input_metadata_ingress_port
+	mov m.psa_ingress_output_metadata_drop 0x0
+	extract h.ethernet
+	jmpeq MYIP_PARSE_IPV4 h.ethernet.etherType 0x800
+	jmp MYIP_ACCEPT
+	MYIP_PARSE_IPV4 :	extract h.ipv4
+	MYIP_ACCEPT :	mov m.t_ip_0_ipv4_srcAddr h.ipv4.srcAddr
+	mov m.t_ip_0_ipv4_dstAddr h.ipv4.dstAddr
+	mov m.t_ip_0_ipv4_protocol h.ipv4.protocol
+	table t_ip
+	jmpnh LABEL_0FALSE
+	mov m.t_ip_0_ipv4_dstAddr h.ipv4.dstAddr
+	mov m.t_ip_0_ipv4_protocol h.ipv4.protocol
+	table t_flow
+	jmp LABEL_0END
+	LABEL_0FALSE :	table t_addr
+	LABEL_0END :	jmple LABEL_1END h.ipv4.ttl 0x1
+	mov m.t_eth_0_ethernet_dstAddr h.ethernet.dstAddr
+	mov m.t_eth_0_ipv4_ttl h.ipv4.ttl
+	table t_eth
+	LABEL_1END :	tx m.psa_ingress_output_metadata_egress_port
+	LABEL_DROP : drop
+}
+
+
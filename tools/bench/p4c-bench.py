@@ -0,0 +1,417 @@
+#!/usr/bin/env python3
+# Copyright 2013-present Barefoot Networks, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Measures the compile time and memory use of the compiler.
+
+Compiles a subset of testdata/p4_16_samples and a few synthetic, scaled-up
+programs with p4test and the bmv2, eBPF and DPDK backends.  The synthetic
+programs come from the templates below and, when it has been built, from
+p4c-stress-gen, which generates v1model, PSA and eBPF programs with a given
+number of tables, actions, key fields, parser states, nesting levels and
+table entries.  For each
+compilation it records the wall time, the peak RSS, the time spent in each
+phase (parse, frontend, midend, backend) and the largest GC heap size.  The
+results can be saved as a baseline, and compared against a baseline with
+configurable regression thresholds.
+
+The phase times come from the --timing-log option of the compiler, which
+logs the time after each pass run by a pass manager with debug hooks:
+  - parse is the time until the first pass of the FrontEnd,
+  - frontend and midend are the time of the passes run by the FrontEnd and
+    by pass managers whose name contains MidEnd,
+  - backend is the rest of the time, until the compiler exits.
+The log also gives the iterations that worklist PassRepeated loops saved by
+only revisiting the declarations that changed; their sum is reported as
+iterations_saved.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+import tempfile
+import time
+import subprocess
+
+SUCCESS = 0
+FAILURE = 1
+
+PHASES = ["parse", "frontend", "midend", "backend"]
+TIME_METRICS = ["wall"] + PHASES
+MEMORY_METRICS = ["rss_kb", "gc_heap"]
+
+
+class Backend(object):
+    def __init__(self, binary, args, include):
+        self.binary = binary    # compiler executable in the build directory
+        self.args = args        # extra arguments, {out} is replaced by the output file prefix
+        self.include = include  # architecture include the programs must use, or None for all
+
+    def accepts(self, source):
+        return self.include is None or ("#include <" + self.include + ">") in source
+
+
+BACKENDS = {
+    "p4test": Backend("p4test", [], None),
+    "bmv2": Backend("p4c-bm2-ss", ["-o", "{out}.json"], "v1model.p4"),
+    "ebpf": Backend("p4c-ebpf", ["-o", "{out}.c"], "ebpf_model.p4"),
+    "dpdk": Backend("p4c-dpdk", ["--arch", "psa", "-o", "{out}.spec"], "psa.p4"),
+}
+
+
+def synthetic_tables(n):
+    """A v1model program with n tables, each with its own action."""
+    fields = max(2, min(n, 16))
+    out = ["#include <core.p4>", "#include <v1model.p4>", ""]
+    out.append("header h_t {")
+    out += ["    bit<32> f%d;" % i for i in range(fields)]
+    out += ["}", "struct headers_t { h_t h; }", "struct meta_t { bit<32> m; }", ""]
+    out += ["parser P(packet_in pkt, out headers_t hdr, inout meta_t meta,",
+            "         inout standard_metadata_t sm) {",
+            "    state start { pkt.extract(hdr.h); transition accept; }", "}", ""]
+    out += ["control Ing(inout headers_t hdr, inout meta_t meta, inout standard_metadata_t sm) {"]
+    for i in range(n):
+        out += ["    action a%d(bit<32> v) { hdr.h.f%d = v + meta.m; meta.m = meta.m + %d; }"
+                % (i, i % fields, i)]
+        out += ["    table t%d {" % i,
+                "        key = { hdr.h.f%d : exact; hdr.h.f%d : ternary; }"
+                % (i % fields, (i + 1) % fields),
+                "        actions = { a%d; NoAction; }" % i,
+                "        default_action = NoAction();", "    }"]
+    out += ["    apply {"]
+    for i in range(n):
+        out += ["        if (hdr.h.f%d != %d) { t%d.apply(); }" % ((i + 1) % fields, i, i)]
+    out += ["    }", "}", ""]
+    return out + v1model_tail()
+
+
+def synthetic_parser(n):
+    """A v1model program whose parser is a chain of n states."""
+    out = ["#include <core.p4>", "#include <v1model.p4>", ""]
+    out += ["header h_t { bit<16> kind; bit<32> v; }", "struct headers_t {"]
+    out += ["    h_t h%d;" % i for i in range(n)]
+    out += ["}", "struct meta_t { bit<32> m; }", ""]
+    out += ["parser P(packet_in pkt, out headers_t hdr, inout meta_t meta,",
+            "         inout standard_metadata_t sm) {",
+            "    state start { transition parse0; }"]
+    for i in range(n):
+        nxt = "parse%d" % (i + 1) if i + 1 < n else "accept"
+        out += ["    state parse%d {" % i,
+                "        pkt.extract(hdr.h%d);" % i,
+                "        meta.m = meta.m + hdr.h%d.v;" % i,
+                "        transition select(hdr.h%d.kind) { 0: accept; default: %s; }" % (i, nxt),
+                "    }"]
+    out += ["}", ""]
+    out += ["control Ing(inout headers_t hdr, inout meta_t meta, inout standard_metadata_t sm) {",
+            "    apply { if (meta.m == 0) { mark_to_drop(sm); } }", "}", ""]
+    return out + v1model_tail(["hdr.h%d" % i for i in range(n)])
+
+
+def v1model_tail(emit=("hdr.h",)):
+    out = ["control Eg(inout headers_t hdr, inout meta_t meta, inout standard_metadata_t sm) {",
+           "    apply { }", "}",
+           "control Ck(inout headers_t hdr, inout meta_t meta) { apply { } }",
+           "control Dep(packet_out pkt, in headers_t hdr) {", "    apply {"]
+    out += ["        pkt.emit(%s);" % h for h in emit]
+    out += ["    }", "}", "", "V1Switch(P(), Ck(), Ing(), Eg(), Ck(), Dep()) main;", ""]
+    return out
+
+
+SYNTHETIC = {
+    "tables": synthetic_tables,
+    "parser": synthetic_parser,
+}
+
+
+def synthetic_programs(spec, tmpdir):
+    """Writes the synthetic programs described by spec (kind:scale,...)."""
+    programs = []
+    for item in filter(None, spec.split(",")):
+        kind, _, scale = item.partition(":")
+        if kind not in SYNTHETIC or not scale.isdigit():
+            raise ValueError("Unknown synthetic program " + item)
+        name = "synthetic-%s-%s.p4" % (kind, scale)
+        path = os.path.join(tmpdir, name)
+        with open(path, "w") as f:
+            f.write("\n".join(SYNTHETIC[kind](int(scale))))
+        programs.append((name, path))
+    return programs
+
+
+STRESS_GEN = "p4c-stress-gen"
+STRESS_KNOBS = ["tables", "actions", "key-fields", "parser-states", "nesting", "entries"]
+DEFAULT_STRESS = [
+    "v1model:tables=1000",
+    "v1model:tables=100:entries=1000",
+    "v1model:parser-states=200",
+    "v1model:tables=200:nesting=50",
+    "psa:tables=200",
+    "ebpf:tables=200:entries=100",
+]
+
+
+def stress_programs(options, specs, tmpdir):
+    """Generates programs with p4c-stress-gen; a spec is arch[:knob=value...]."""
+    generator = os.path.join(options.builddir, STRESS_GEN)
+    if not specs:
+        return []
+    if not os.path.exists(generator):
+        print("Skipping stress programs: %s was not built" % STRESS_GEN)
+        return []
+    programs = []
+    for spec in filter(None, specs):
+        knobs = spec.split(":")
+        args = [generator, "--arch", knobs[0]]
+        for knob in knobs[1:]:
+            key, _, value = knob.partition("=")
+            if key not in STRESS_KNOBS or not value.isdigit():
+                raise ValueError("Unknown stress program knob " + knob)
+            args += ["--" + key, value]
+        name = "stress-%s.p4" % re.sub("[:=]", "-", spec)
+        path = os.path.join(tmpdir, name)
+        subprocess.check_call(args + ["-o", path])
+        programs.append((name, path))
+    return programs
+
+
+def read_source(path):
+    with open(path, errors="replace") as f:
+        return f.read()
+
+
+def select_samples(options, backend):
+    """The testdata programs the backend can compile, filtered by the options."""
+    sampledir = os.path.join(options.srcdir, "testdata", "p4_16_samples")
+    names = sorted(f for f in os.listdir(sampledir) if f.endswith(".p4"))
+    if options.filter:
+        names = [n for n in names if re.search(options.filter, n)]
+    selected = []
+    for name in names:
+        path = os.path.join(sampledir, name)
+        if backend.accepts(read_source(path)):
+            selected.append((name, path))
+    if options.limit and len(selected) > options.limit:
+        # spread the subset over the whole corpus, so it is the same in every run
+        step = len(selected) / options.limit
+        selected = [selected[int(i * step)] for i in range(options.limit)]
+    return selected
+
+
+def phase_times(logfile, wall):
+    """Splits the wall time of a compilation into phases, using its timing log."""
+    phases = dict.fromkeys(PHASES, 0.0)
+    gc_heap = 0
+    saved = 0.0
+    last = 0.0
+    seen_frontend = False
+    if os.path.exists(logfile):
+        with open(logfile) as f:
+            for line in f:
+                fields = line.rstrip("\n").split("\t")
+                if len(fields) != 5:
+                    continue
+                manager, _, usecs, heap, iterations = fields
+                now = int(usecs) / 1e6
+                if manager == "FrontEnd":
+                    seen_frontend = True
+                    phase = "frontend" if last > 0 else "parse"
+                elif "MidEnd" in manager:
+                    phase = "midend"
+                elif not seen_frontend:
+                    phase = "parse"
+                else:
+                    phase = "backend"
+                phases[phase] += now - last
+                last = now
+                gc_heap = max(gc_heap, int(heap))
+                saved += float(iterations)
+    phases["backend"] += max(0.0, wall - last)
+    return phases, gc_heap, saved
+
+
+def compile_once(options, backend, path, tmpdir):
+    out = os.path.join(tmpdir, "out")
+    logfile = os.path.join(tmpdir, "timing.log")
+    if os.path.exists(logfile):
+        os.remove(logfile)
+    args = [os.path.join(options.builddir, backend.binary), "--timing-log", logfile]
+    args += [a.replace("{out}", out) for a in backend.args] + [path]
+    if options.verbose:
+        print(" ".join(args))
+    start = time.monotonic()
+    proc = subprocess.Popen(args, cwd=options.builddir,
+                            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    # wait4 gives the resource usage of this child alone
+    while True:
+        pid, status, usage = os.wait4(proc.pid, os.WNOHANG)
+        if pid != 0:
+            break
+        if time.monotonic() - start > options.timeout:
+            proc.kill()
+            os.wait4(proc.pid, 0)
+            proc.returncode = -1
+            return {"status": "timeout"}
+        time.sleep(0.001)
+    wall = time.monotonic() - start
+    code = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -os.WTERMSIG(status)
+    proc.returncode = code  # reaped by wait4 already
+    phases, gc_heap, saved = phase_times(logfile, wall)
+    result = {"status": "ok" if code == 0 else "error %d" % code,
+              "wall": wall, "rss_kb": usage.ru_maxrss, "gc_heap": gc_heap,
+              "iterations_saved": saved}
+    result.update(phases)
+    return result
+
+
+def compile_program(options, backend, path, tmpdir):
+    """Compiles a program options.repeat times, keeping the fastest run."""
+    best = None
+    for _ in range(options.repeat):
+        result = compile_once(options, backend, path, tmpdir)
+        if best is None or ("wall" in result and result["wall"] < best.get("wall", 1e30)):
+            best = result
+    return best
+
+
+def compare(options, results, baseline):
+    """Returns the metrics that regressed beyond the thresholds."""
+    regressions = []
+    for key, result in sorted(results.items()):
+        base = baseline.get("results", {}).get(key)
+        if base is None or result.get("status") != "ok" or base.get("status") != "ok":
+            continue
+        for metric in TIME_METRICS + MEMORY_METRICS:
+            if metric not in result or metric not in base:
+                continue
+            old, new = base[metric], result[metric]
+            if metric in TIME_METRICS:
+                threshold = options.time_threshold
+                if max(old, new) < options.min_time:
+                    continue
+            else:
+                threshold = options.memory_threshold
+            if old > 0 and new > old * (1 + threshold):
+                regressions.append((key, metric, old, new))
+    return regressions
+
+
+def summarize(results):
+    totals = {}
+    for key, result in results.items():
+        backend = key.split("/")[0]
+        total = totals.setdefault(backend, dict.fromkeys(["programs", "failed", "iterations_saved"] +
+                                                         TIME_METRICS, 0))
+        total["programs"] += 1
+        if result.get("status") != "ok":
+            total["failed"] += 1
+            continue
+        for metric in TIME_METRICS:
+            total[metric] += result[metric]
+        total["iterations_saved"] += result.get("iterations_saved", 0)
+    print("%-8s %8s %6s %9s %9s %9s %9s %9s %9s" %
+          ("backend", "programs", "failed", "wall", "parse", "frontend", "midend", "backend",
+           "saved"))
+    for backend, total in sorted(totals.items()):
+        print("%-8s %8d %6d %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f" %
+              (backend, total["programs"], total["failed"], total["wall"], total["parse"],
+               total["frontend"], total["midend"], total["backend"], total["iterations_saved"]))
+    slowest = sorted((r["wall"], k) for k, r in results.items() if "wall" in r)[-5:]
+    if slowest:
+        print("slowest:")
+        for wall, key in reversed(slowest):
+            r = results[key]
+            print("  %-50s %7.2fs %8d KB RSS %10d B GC heap" % (key, wall, r["rss_kb"],
+                                                                r["gc_heap"]))
+
+
+def main(argv):
+    srcdir = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--builddir", default=os.path.join(srcdir, "build"),
+                        help="directory containing the compiler executables")
+    parser.add_argument("--srcdir", default=srcdir, help="root of the compiler source tree")
+    parser.add_argument("--backends", default=",".join(sorted(BACKENDS)),
+                        help="comma-separated backends to run (default: %(default)s)")
+    parser.add_argument("--filter", help="only compile the samples whose name matches this regex")
+    parser.add_argument("--limit", type=int, default=0,
+                        help="compile at most this many samples per backend")
+    parser.add_argument("--synthetic", default="tables:100,tables:1000,parser:100",
+                        help="synthetic v1model programs to compile, as kind:scale,... "
+                             "with kind in " + ", ".join(sorted(SYNTHETIC)) +
+                             " (default: %(default)s)")
+    parser.add_argument("--stress", action="append",
+                        help="program to generate with " + STRESS_GEN + ", as "
+                             "arch[:knob=value...] with arch in v1model, psa, ebpf and knob in " +
+                             ", ".join(STRESS_KNOBS) + "; can be repeated, and an empty "
+                             "value disables the generated programs "
+                             "(default: " + " ".join(DEFAULT_STRESS) + ")")
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="compile each program this many times and keep the fastest run")
+    parser.add_argument("--timeout", type=float, default=600, help="seconds per compilation")
+    parser.add_argument("--baseline", help="compare the results against this JSON file")
+    parser.add_argument("--save", help="write the results as JSON to this file")
+    parser.add_argument("--time-threshold", type=float, default=0.10,
+                        help="relative increase in a time that is a regression")
+    parser.add_argument("--memory-threshold", type=float, default=0.05,
+                        help="relative increase in RSS or GC heap that is a regression")
+    parser.add_argument("--min-time", type=float, default=0.05,
+                        help="ignore times below this many seconds, which are mostly noise")
+    parser.add_argument("-v", "--verbose", action="store_true")
+    options = parser.parse_args(argv[1:])
+    options.builddir = os.path.abspath(options.builddir)
+
+    results = {}
+    with tempfile.TemporaryDirectory(prefix="p4c-bench-") as tmpdir:
+        synthetic = synthetic_programs(options.synthetic, tmpdir)
+        stress = options.stress if options.stress is not None else DEFAULT_STRESS
+        synthetic += stress_programs(options, stress, tmpdir)
+        for name in options.backends.split(","):
+            if name not in BACKENDS:
+                print("Unknown backend", name, file=sys.stderr)
+                return FAILURE
+            backend = BACKENDS[name]
+            if not os.path.exists(os.path.join(options.builddir, backend.binary)):
+                print("Skipping %s: %s was not built" % (name, backend.binary))
+                continue
+            programs = select_samples(options, backend)
+            programs += [p for p in synthetic if backend.accepts(read_source(p[1]))]
+            print("Compiling %d programs with %s" % (len(programs), backend.binary))
+            for program, path in programs:
+                key = name + "/" + program
+                results[key] = compile_program(options, backend, path, tmpdir)
+                if options.verbose or results[key]["status"] != "ok":
+                    print("  %s: %s" % (key, json.dumps(results[key], sort_keys=True)))
+
+    summarize(results)
+    report = {"results": results}
+    if options.save:
+        with open(options.save, "w") as f:
+            json.dump(report, f, indent=1, sort_keys=True)
+    if options.baseline:
+        with open(options.baseline) as f:
+            baseline = json.load(f)
+        regressions = compare(options, results, baseline)
+        for key, metric, old, new in regressions:
+            print("REGRESSION %s %s: %g -> %g (%+.1f%%)" %
+                  (key, metric, old, new, 100.0 * (new - old) / old))
+        if regressions:
+            return FAILURE
+    return SUCCESS
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,109 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/* Emits synthetic P4 programs of a configurable size, for scaling tests. */
+
+#include <cstdlib>
+#include <iostream>
+#include "frontends/common/options.h"
+#include "lib/crash.h"
+#include "lib/error.h"
+#include "lib/gc.h"
+#include "lib/nullstream.h"
+#include "lib/options.h"
+#include "stressgen.h"
+
+namespace StressGen {
+
+class GeneratorOptions : public Util::Options {
+    static bool parseCount(const char* arg, unsigned &count) {
+        char* end = nullptr;
+        auto value = strtoul(arg, &end, 10);
+        if (*arg == '\0' || *end != '\0') {
+            ::error(ErrorType::ERR_INVALID, "%1%: expected a non-negative number", arg);
+            return false;
+        }
+        count = value;
+        return true;
+    }
+
+ public:
+    StressOptions stress;
+    cstring outputFile = nullptr;
+
+    GeneratorOptions() : Util::Options("Generate a synthetic P4 program for scaling tests") {
+        registerOption("--arch", "arch",
+                       [this](const char* arg) {
+                           if (StressOptions::parseArch(arg, stress.arch))
+                               return true;
+                           ::error(ErrorType::ERR_INVALID, "%1%: unknown architecture", arg);
+                           return false; },
+                       "Target architecture: v1model (default), psa or ebpf");
+        registerOption("--tables", "count",
+                       [this](const char* arg) { return parseCount(arg, stress.tables); },
+                       "Number of tables (default 16)");
+        registerOption("--actions", "count",
+                       [this](const char* arg) { return parseCount(arg, stress.actions); },
+                       "Number of actions; every table lists all of them (default 4)");
+        registerOption("--key-fields", "count",
+                       [this](const char* arg) { return parseCount(arg, stress.keyFields); },
+                       "Number of key fields per table (default 2)");
+        registerOption("--parser-states", "count",
+                       [this](const char* arg) { return parseCount(arg, stress.parserStates); },
+                       "Number of parser states and header instances (default 4)");
+        registerOption("--nesting", "depth",
+                       [this](const char* arg) { return parseCount(arg, stress.nesting); },
+                       "Depth of the if statements around table applications (default 2)");
+        registerOption("--entries", "count",
+                       [this](const char* arg) { return parseCount(arg, stress.entries); },
+                       "Number of const entries per table (default 0)");
+        registerOption("-o", "file",
+                       [this](const char* arg) { outputFile = arg; return true; },
+                       "Write the program to this file instead of stdout");
+    }
+
+    const char* getIncludePath() override { return ""; }
+};
+
+}  // namespace StressGen
+
+int main(int argc, char *const argv[]) {
+    setup_gc_logging();
+    setup_signals();
+
+    AutoCompileContext autoContext(new P4CContextWithOptions<CompilerOptions>);
+    StressGen::GeneratorOptions options;
+    auto remaining = options.process(argc, argv);
+    if (remaining == nullptr || ::errorCount() > 0)
+        return 1;
+    if (!remaining->empty()) {
+        ::error(ErrorType::ERR_UNEXPECTED, "%1%: unexpected argument", remaining->front());
+        options.usage();
+        return 1;
+    }
+
+    std::ostream* out = &std::cout;
+    if (options.outputFile) {
+        out = openFile(options.outputFile, false);
+        if (out == nullptr)
+            return 1;
+    }
+
+    auto program = StressGen::generateProgram(options.stress);
+    StressGen::emitProgram(*out, program, options.stress.arch);
+    out->flush();
+    return ::errorCount() > 0;
+}
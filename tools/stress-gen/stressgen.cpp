@@ -0,0 +1,435 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stressgen.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include "frontends/p4/toP4/toP4.h"
+
+namespace StressGen {
+
+bool StressOptions::parseArch(cstring name, Arch &arch) {
+    if (name == "v1model")
+        arch = Arch::V1Model;
+    else if (name == "psa")
+        arch = Arch::PSA;
+    else if (name == "ebpf")
+        arch = Arch::EBPF;
+    else
+        return false;
+    return true;
+}
+
+cstring archIncludes(Arch arch) {
+    switch (arch) {
+        case Arch::V1Model:
+            return "#include <core.p4>\n#include <v1model.p4>\n";
+        case Arch::PSA:
+            return "#include <core.p4>\n#include <psa.p4>\n";
+        case Arch::EBPF:
+            return "#include <core.p4>\n#include <ebpf_model.p4>\n";
+    }
+    BUG("Unexpected architecture");
+}
+
+void emitProgram(std::ostream &out, const IR::P4Program* program, Arch arch,
+                 bool withIncludes) {
+    if (withIncludes)
+        out << archIncludes(arch) << std::endl;
+    P4::ToP4 top4(&out, false);
+    program->apply(top4);
+}
+
+namespace {
+
+/**
+ * Builds the program described in StressOptions.  All architectures share
+ * the same shape:
+ *
+ *  - a header type `stress_h` with `keyFields` 16-bit fields and an 8-bit
+ *    `nxt` field, and a struct `headers_t` with one instance per parser state;
+ *  - a parser whose states form a chain, each state extracting its header
+ *    and selecting on `nxt` to continue or accept;
+ *  - a main control with `actions` actions and `tables` tables, each table
+ *    matching exactly on all fields of one header and listing all actions;
+ *  - the remaining architecture blocks, which are empty except for the
+ *    deparser emitting the headers.
+ */
+class ProgramBuilder {
+    const StressOptions &options;
+    unsigned fieldCount;
+    unsigned headerCount;
+    IR::Vector<IR::Node>* declarations;
+
+    static const IR::Type_Bits* fieldType() { return IR::Type_Bits::get(16); }
+
+    static const IR::Parameter* param(cstring name, IR::Direction direction,
+                                      cstring type) {
+        return new IR::Parameter(IR::ID(name), direction, new IR::Type_Name(IR::ID(type)));
+    }
+
+    static const IR::Type_Struct* emptyStruct(cstring name) {
+        return new IR::Type_Struct(IR::ID(name), IR::IndexedVector<IR::StructField>());
+    }
+
+    static const IR::MethodCallStatement* call(const IR::Expression* method,
+                                               std::initializer_list<const IR::Expression*> args) {
+        auto arguments = new IR::Vector<IR::Argument>();
+        for (auto a : args)
+            arguments->push_back(new IR::Argument(a));
+        return new IR::MethodCallStatement(new IR::MethodCallExpression(method, arguments));
+    }
+
+    static const IR::ConstructorCallExpression* construct(cstring type) {
+        return new IR::ConstructorCallExpression(
+            new IR::Type_Name(IR::ID(type)), new IR::Vector<IR::Argument>());
+    }
+
+    const IR::Expression* header(unsigned index) const {
+        return new IR::Member(new IR::PathExpression(IR::ID("hdr")),
+                              IR::ID(cstring("h") + Util::toString(index % headerCount)));
+    }
+    const IR::Expression* field(unsigned hdr, unsigned index) const {
+        return new IR::Member(header(hdr), IR::ID(cstring("f") + Util::toString(index)));
+    }
+    static cstring tableName(unsigned index) { return cstring("t") + Util::toString(index); }
+    static cstring actionName(unsigned index) { return cstring("a") + Util::toString(index); }
+
+    void add(const IR::Node* node) { declarations->push_back(node); }
+
+    void addTypes() {
+        IR::IndexedVector<IR::StructField> fields;
+        for (unsigned i = 0; i < fieldCount; i++)
+            fields.push_back(new IR::StructField(
+                IR::ID(cstring("f") + Util::toString(i)), fieldType()));
+        fields.push_back(new IR::StructField(IR::ID("nxt"), IR::Type_Bits::get(8)));
+        add(new IR::Type_Header(IR::ID("stress_h"), fields));
+
+        IR::IndexedVector<IR::StructField> headers;
+        for (unsigned i = 0; i < headerCount; i++)
+            headers.push_back(new IR::StructField(
+                IR::ID(cstring("h") + Util::toString(i)), new IR::Type_Name(IR::ID("stress_h"))));
+        add(new IR::Type_Struct(IR::ID("headers_t"), headers));
+
+        if (options.arch == Arch::V1Model)
+            add(emptyStruct("metadata_t"));
+        else if (options.arch == Arch::PSA)
+            add(emptyStruct("empty_t"));
+    }
+
+    /// A parser whose only state accepts; used for the blocks that the
+    /// architecture requires but the stress program does not exercise.
+    const IR::P4Parser* emptyParser(cstring name, const IR::ParameterList* params) const {
+        IR::IndexedVector<IR::ParserState> states;
+        states.push_back(new IR::ParserState(
+            IR::ID(IR::ParserState::start),
+            new IR::PathExpression(IR::ID(IR::ParserState::accept))));
+        auto type = new IR::Type_Parser(IR::ID(name), new IR::TypeParameters(), params);
+        return new IR::P4Parser(IR::ID(name), type, IR::IndexedVector<IR::Declaration>(), states);
+    }
+
+    const IR::P4Parser* mainParser(cstring name, const IR::ParameterList* params) const {
+        IR::IndexedVector<IR::ParserState> states;
+        for (unsigned i = 0; i < headerCount; i++) {
+            cstring stateName = i == 0 ? IR::ParserState::start
+                                       : cstring("parse_h") + Util::toString(i);
+            IR::IndexedVector<IR::StatOrDecl> components;
+            components.push_back(call(new IR::Member(new IR::PathExpression(IR::ID("packet")),
+                                                     IR::ID("extract")),
+                                      { header(i) }));
+            const IR::Expression* select;
+            if (i + 1 < headerCount) {
+                IR::Vector<IR::SelectCase> cases;
+                cases.push_back(new IR::SelectCase(
+                    new IR::Constant(IR::Type_Bits::get(8), 1),
+                    new IR::PathExpression(IR::ID(cstring("parse_h") + Util::toString(i + 1)))));
+                cases.push_back(new IR::SelectCase(
+                    new IR::DefaultExpression(),
+                    new IR::PathExpression(IR::ID(IR::ParserState::accept))));
+                IR::Vector<IR::Expression> keys;
+                keys.push_back(new IR::Member(header(i), IR::ID("nxt")));
+                select = new IR::SelectExpression(new IR::ListExpression(keys), std::move(cases));
+            } else {
+                select = new IR::PathExpression(IR::ID(IR::ParserState::accept));
+            }
+            states.push_back(new IR::ParserState(IR::ID(stateName), components, select));
+        }
+        auto type = new IR::Type_Parser(IR::ID(name), new IR::TypeParameters(), params);
+        return new IR::P4Parser(IR::ID(name), type, IR::IndexedVector<IR::Declaration>(), states);
+    }
+
+    static const IR::P4Control* control(cstring name, const IR::ParameterList* params,
+                                        const IR::IndexedVector<IR::Declaration> &locals,
+                                        const IR::BlockStatement* body) {
+        auto type = new IR::Type_Control(IR::ID(name), params);
+        return new IR::P4Control(IR::ID(name), type, locals, body);
+    }
+
+    const IR::P4Control* emptyControl(cstring name, const IR::ParameterList* params) const {
+        return control(name, params, IR::IndexedVector<IR::Declaration>(),
+                       new IR::BlockStatement());
+    }
+
+    const IR::P4Control* deparser(cstring name, const IR::ParameterList* params) const {
+        IR::IndexedVector<IR::StatOrDecl> body;
+        body.push_back(call(new IR::Member(new IR::PathExpression(IR::ID("packet")),
+                                           IR::ID("emit")),
+                            { new IR::PathExpression(IR::ID("hdr")) }));
+        return control(name, params, IR::IndexedVector<IR::Declaration>(),
+                       new IR::BlockStatement(body));
+    }
+
+    const IR::P4Action* action(unsigned index) const {
+        auto params = new IR::ParameterList();
+        params->push_back(new IR::Parameter(IR::ID("v"), IR::Direction::None, fieldType()));
+        IR::IndexedVector<IR::StatOrDecl> body;
+        body.push_back(new IR::AssignmentStatement(
+            field(index, index % fieldCount), new IR::PathExpression(IR::ID("v"))));
+        return new IR::P4Action(IR::ID(actionName(index)), params,
+                                new IR::BlockStatement(body));
+    }
+
+    const IR::P4Table* table(unsigned index) const {
+        auto properties = new IR::TableProperties();
+        if (options.keyFields > 0) {
+            auto key = new IR::Key({});
+            for (unsigned f = 0; f < options.keyFields; f++)
+                key->push_back(new IR::KeyElement(
+                    field(index, f), new IR::PathExpression(IR::ID("exact"))));
+            properties->push_back(new IR::Property(
+                IR::ID(IR::TableProperties::keyPropertyName), key, false));
+        }
+
+        auto actions = new IR::ActionList({});
+        for (unsigned a = 0; a < options.actions; a++)
+            actions->push_back(new IR::ActionListElement(
+                new IR::PathExpression(IR::ID(actionName(a)))));
+        actions->push_back(new IR::ActionListElement(
+            new IR::PathExpression(IR::ID("NoAction"))));
+        properties->push_back(new IR::Property(
+            IR::ID(IR::TableProperties::actionsPropertyName), actions, false));
+
+        if (options.entries > 0 && options.keyFields > 0 && options.actions > 0) {
+            // Each entry matches a distinct key: entry e puts the 16-bit
+            // digits of e into consecutive key fields.
+            IR::Vector<IR::Entry> entries;
+            for (unsigned e = 0; e < options.entries; e++) {
+                IR::Vector<IR::Expression> keys;
+                unsigned long long value = e;
+                for (unsigned f = 0; f < options.keyFields; f++) {
+                    keys.push_back(new IR::Constant(fieldType(), value & 0xFFFF));
+                    value >>= 16;
+                }
+                auto arguments = new IR::Vector<IR::Argument>();
+                arguments->push_back(new IR::Argument(new IR::Constant(fieldType(), e & 0xFFFF)));
+                auto act = new IR::MethodCallExpression(
+                    new IR::PathExpression(IR::ID(actionName(e % options.actions))), arguments);
+                entries.push_back(new IR::Entry(new IR::ListExpression(keys), act));
+            }
+            properties->push_back(new IR::Property(
+                IR::ID(IR::TableProperties::entriesPropertyName),
+                new IR::EntriesList(entries), true));
+        }
+
+        properties->push_back(new IR::Property(
+            IR::ID(IR::TableProperties::defaultActionPropertyName),
+            new IR::ExpressionValue(new IR::MethodCallExpression(
+                new IR::PathExpression(IR::ID("NoAction")), new IR::Vector<IR::Argument>())),
+            false));
+
+        unsigned size = std::max(options.entries, 1024u);
+        if (options.arch == Arch::EBPF) {
+            auto args = new IR::Vector<IR::Argument>();
+            args->push_back(new IR::Argument(new IR::Constant(IR::Type_Bits::get(32), size)));
+            properties->push_back(new IR::Property(
+                IR::ID("implementation"),
+                new IR::ExpressionValue(new IR::ConstructorCallExpression(
+                    new IR::Type_Name(IR::ID("hash_table")), args)),
+                false));
+        } else {
+            properties->push_back(new IR::Property(
+                IR::ID(IR::TableProperties::sizePropertyName),
+                new IR::ExpressionValue(new IR::Constant(static_cast<int>(size))), false));
+        }
+        return new IR::P4Table(IR::ID(tableName(index)), properties);
+    }
+
+    /// The statements at nesting level @p level: the applications of the
+    /// tables assigned to this level, followed by an if statement holding
+    /// the next level.  Tables are assigned round-robin to levels.
+    IR::IndexedVector<IR::StatOrDecl> nest(unsigned level) const {
+        IR::IndexedVector<IR::StatOrDecl> result;
+        for (unsigned t = level; t < options.tables; t += options.nesting + 1)
+            result.push_back(call(new IR::Member(new IR::PathExpression(IR::ID(tableName(t))),
+                                                 IR::ID(IR::IApply::applyMethodName)),
+                                  {}));
+        if (level < options.nesting) {
+            auto condition = new IR::Neq(field(level, 0), new IR::Constant(fieldType(), level));
+            result.push_back(new IR::IfStatement(
+                condition, new IR::BlockStatement(nest(level + 1)), nullptr));
+        }
+        return result;
+    }
+
+    const IR::P4Control* mainControl(cstring name, const IR::ParameterList* params) const {
+        IR::IndexedVector<IR::Declaration> locals;
+        for (unsigned a = 0; a < options.actions; a++)
+            locals.push_back(action(a));
+        for (unsigned t = 0; t < options.tables; t++)
+            locals.push_back(table(t));
+
+        IR::IndexedVector<IR::StatOrDecl> body;
+        if (options.arch == Arch::EBPF)
+            body.push_back(new IR::AssignmentStatement(
+                new IR::PathExpression(IR::ID("pass")), new IR::BoolLiteral(true)));
+        body.append(nest(0));
+        return control(name, params, locals, new IR::BlockStatement(body));
+    }
+
+    const IR::Declaration_Instance* instance(
+            cstring name, cstring type,
+            std::initializer_list<const IR::Expression*> args) const {
+        auto arguments = new IR::Vector<IR::Argument>();
+        for (auto a : args)
+            arguments->push_back(new IR::Argument(a));
+        return new IR::Declaration_Instance(
+            IR::ID(name), new IR::Type_Name(IR::ID(type)), arguments);
+    }
+
+    void addV1Model() {
+        auto hdr = [] { return param("hdr", IR::Direction::InOut, "headers_t"); };
+        auto meta = [] { return param("meta", IR::Direction::InOut, "metadata_t"); };
+        auto stdMeta = [] {
+            return param("standard_metadata", IR::Direction::InOut, "standard_metadata_t");
+        };
+        add(mainParser("StressParser", new IR::ParameterList({
+            param("packet", IR::Direction::None, "packet_in"),
+            param("hdr", IR::Direction::Out, "headers_t"), meta(), stdMeta() })));
+        add(emptyControl("StressVerifyChecksum", new IR::ParameterList({ hdr(), meta() })));
+        add(mainControl("StressIngress", new IR::ParameterList({ hdr(), meta(), stdMeta() })));
+        add(emptyControl("StressEgress", new IR::ParameterList({ hdr(), meta(), stdMeta() })));
+        add(emptyControl("StressComputeChecksum", new IR::ParameterList({ hdr(), meta() })));
+        add(deparser("StressDeparser", new IR::ParameterList({
+            param("packet", IR::Direction::None, "packet_out"),
+            param("hdr", IR::Direction::In, "headers_t") })));
+        add(instance(IR::P4Program::main, "V1Switch", {
+            construct("StressParser"), construct("StressVerifyChecksum"),
+            construct("StressIngress"), construct("StressEgress"),
+            construct("StressComputeChecksum"), construct("StressDeparser") }));
+    }
+
+    void addPSA() {
+        using IR::Direction;
+        auto empty = [](cstring name, Direction direction) {
+            return param(name, direction, "empty_t");
+        };
+        add(mainParser("StressIngressParser", new IR::ParameterList({
+            param("packet", Direction::None, "packet_in"),
+            param("hdr", Direction::Out, "headers_t"),
+            empty("meta", Direction::InOut),
+            param("istd", Direction::In, "psa_ingress_parser_input_metadata_t"),
+            empty("resubmit_meta", Direction::In),
+            empty("recirculate_meta", Direction::In) })));
+        add(mainControl("StressIngress", new IR::ParameterList({
+            param("hdr", Direction::InOut, "headers_t"),
+            empty("meta", Direction::InOut),
+            param("istd", Direction::In, "psa_ingress_input_metadata_t"),
+            param("ostd", Direction::InOut, "psa_ingress_output_metadata_t") })));
+        add(deparser("StressIngressDeparser", new IR::ParameterList({
+            param("packet", Direction::None, "packet_out"),
+            empty("clone_i2e_meta", Direction::Out),
+            empty("resubmit_meta", Direction::Out),
+            empty("normal_meta", Direction::Out),
+            param("hdr", Direction::InOut, "headers_t"),
+            empty("meta", Direction::In),
+            param("istd", Direction::In, "psa_ingress_output_metadata_t") })));
+        add(emptyParser("StressEgressParser", new IR::ParameterList({
+            param("packet", Direction::None, "packet_in"),
+            empty("hdr", Direction::Out),
+            empty("meta", Direction::InOut),
+            param("istd", Direction::In, "psa_egress_parser_input_metadata_t"),
+            empty("normal_meta", Direction::In),
+            empty("clone_i2e_meta", Direction::In),
+            empty("clone_e2e_meta", Direction::In) })));
+        add(emptyControl("StressEgress", new IR::ParameterList({
+            empty("hdr", Direction::InOut),
+            empty("meta", Direction::InOut),
+            param("istd", Direction::In, "psa_egress_input_metadata_t"),
+            param("ostd", Direction::InOut, "psa_egress_output_metadata_t") })));
+        add(emptyControl("StressEgressDeparser", new IR::ParameterList({
+            param("packet", Direction::None, "packet_out"),
+            empty("clone_e2e_meta", Direction::Out),
+            empty("recirculate_meta", Direction::Out),
+            empty("hdr", Direction::InOut),
+            empty("meta", Direction::In),
+            param("istd", Direction::In, "psa_egress_output_metadata_t"),
+            param("edstd", Direction::In, "psa_egress_deparser_input_metadata_t") })));
+        add(instance("ip", "IngressPipeline", {
+            construct("StressIngressParser"), construct("StressIngress"),
+            construct("StressIngressDeparser") }));
+        add(instance("ep", "EgressPipeline", {
+            construct("StressEgressParser"), construct("StressEgress"),
+            construct("StressEgressDeparser") }));
+        add(instance(IR::P4Program::main, "PSA_Switch", {
+            new IR::PathExpression(IR::ID("ip")), construct("PacketReplicationEngine"),
+            new IR::PathExpression(IR::ID("ep")), construct("BufferingQueueingEngine") }));
+    }
+
+    void addEBPF() {
+        add(mainParser("prs", new IR::ParameterList({
+            param("packet", IR::Direction::None, "packet_in"),
+            param("hdr", IR::Direction::Out, "headers_t") })));
+        add(mainControl("pipe", new IR::ParameterList({
+            param("hdr", IR::Direction::InOut, "headers_t"),
+            new IR::Parameter(IR::ID("pass"), IR::Direction::Out,
+                              IR::Type_Boolean::get()) })));
+        add(instance(IR::P4Program::main, "ebpfFilter", {
+            construct("prs"), construct("pipe") }));
+    }
+
+ public:
+    explicit ProgramBuilder(const StressOptions &options) :
+            options(options),
+            fieldCount(std::max(options.keyFields, 1u)),
+            headerCount(std::max(options.parserStates, 1u)),
+            declarations(new IR::Vector<IR::Node>()) {}
+
+    const IR::P4Program* build() {
+        addTypes();
+        switch (options.arch) {
+            case Arch::V1Model:
+                addV1Model();
+                break;
+            case Arch::PSA:
+                addPSA();
+                break;
+            case Arch::EBPF:
+                addEBPF();
+                break;
+        }
+        return new IR::P4Program(Util::SourceInfo(), *declarations);
+    }
+};
+
+}  // namespace
+
+const IR::P4Program* generateProgram(const StressOptions &options) {
+    return ProgramBuilder(options).build();
+}
+
+}  // namespace StressGen
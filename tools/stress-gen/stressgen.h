@@ -0,0 +1,65 @@
+/*
+Copyright 2013-present Barefoot Networks, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _TOOLS_STRESS_GEN_STRESSGEN_H_
+#define _TOOLS_STRESS_GEN_STRESSGEN_H_
+
+#include <ostream>
+#include "ir/ir.h"
+
+namespace StressGen {
+
+enum class Arch { V1Model, PSA, EBPF };
+
+/// Scale knobs for a synthetic program.  All counts are independent, so a
+/// scaling curve is obtained by varying one knob and keeping the others fixed.
+struct StressOptions {
+    Arch arch = Arch::V1Model;
+    /// Number of tables in the main control; each one is applied once.
+    unsigned tables = 16;
+    /// Number of actions; every table lists all of them.
+    unsigned actions = 4;
+    /// Number of 16-bit fields per header; every table matches on all of them.
+    unsigned keyFields = 2;
+    /// Number of parser states; each state extracts its own header instance.
+    unsigned parserStates = 4;
+    /// Depth of the if-statement nest the table applications are spread over.
+    unsigned nesting = 2;
+    /// Number of `const entries` per table.
+    unsigned entries = 0;
+
+    /// Parses an architecture name ("v1model", "psa" or "ebpf").
+    /// @return false if the name is not recognized.
+    static bool parseArch(cstring name, Arch &arch);
+};
+
+/// Builds a complete program for @p options.arch out of IR nodes.  The result
+/// refers to the architecture declarations by name only, so it has to be
+/// printed with emitProgram (or prepended with the architecture headers)
+/// before it can be compiled.
+const IR::P4Program* generateProgram(const StressOptions &options);
+
+/// The `#include` lines that a program for @p arch needs.
+cstring archIncludes(Arch arch);
+
+/// Prints @p program as P4 source, preceded by the includes for @p arch if
+/// @p withIncludes is set.
+void emitProgram(std::ostream &out, const IR::P4Program* program, Arch arch,
+                 bool withIncludes = true);
+
+}  // namespace StressGen
+
+#endif /* _TOOLS_STRESS_GEN_STRESSGEN_H_ */